@@ -0,0 +1,131 @@
+/** \file
+ * \brief Compile-time alphabets of anagram key calculators.
+ */
+
+#ifndef ALGORITHMS_ALPHABET_HPP_INCLUDED
+#define ALGORITHMS_ALPHABET_HPP_INCLUDED
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string_view>
+#include <type_traits> // std::conditional_t
+
+namespace algos {
+
+/*
+ * An alphabet is a type with two static constexpr members:
+ * - std::string_view symbols - the distinct symbols in the order used by the keys
+ * - bool caseInsensitive - ASCII letters of both cases are the same symbol (then only one case is listed)
+ *
+ * AlphabetTraits turns it into a 256-entry symbol index table at compile time.
+ */
+
+/// Case-insensitive English letters in alphabetical order.
+struct AsciiLetters {
+    static constexpr std::string_view symbols = "ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+    static constexpr bool caseInsensitive = true;
+};
+
+/// Case-insensitive English letters from the most to the least frequent.
+struct EnglishFrequencyLetters {
+    static constexpr std::string_view symbols = "ETAOINSRHDLUCMFYWGPBVKXQJZ";
+    static constexpr bool caseInsensitive = true;
+};
+
+/// Decimal digits.
+struct Digits {
+    static constexpr std::string_view symbols = "0123456789";
+    static constexpr bool caseInsensitive = false;
+};
+
+namespace detail {
+
+constexpr std::array<char, 256> makeAllBytes() {
+    std::array<char, 256> bytes{};
+    for (std::size_t i = 0; i < bytes.size(); ++i) {
+        bytes[i] = static_cast<char>(static_cast<unsigned char>(i));
+    }
+    return bytes;
+}
+
+inline constexpr std::array<char, 256> allBytes = makeAllBytes();
+
+} // namespace detail
+
+/// All 256 byte values, each a symbol of its own (e.g. for text in any single-byte encoding).
+struct Bytes {
+    static constexpr std::string_view symbols{detail::allBytes.data(), detail::allBytes.size()};
+    static constexpr bool caseInsensitive = false;
+};
+
+/// Symbol index table and properties of \p Alphabet, all computed at compile time.
+template <typename Alphabet>
+struct AlphabetTraits {
+    /// Number of distinct symbols.
+    static constexpr std::size_t size = Alphabet::symbols.size();
+
+    /// Smallest unsigned type holding every index and \ref notASymbol.
+    using index_type = std::conditional_t<(size < 256), std::uint8_t, std::uint16_t>;
+
+    /// Marks bytes that are not symbols of the alphabet in \ref indexTable.
+    static constexpr index_type notASymbol = static_cast<index_type>(~index_type{0});
+
+private:
+    static constexpr bool isAsciiLetter(char c) noexcept {
+        return (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z');
+    }
+
+    static constexpr std::array<index_type, 256> makeIndexTable() {
+        std::array<index_type, 256> table{};
+        for (auto &entry : table) {
+            entry = notASymbol;
+        }
+        for (std::size_t i = 0; i < size; ++i) {
+            const auto c = Alphabet::symbols[i];
+            table[static_cast<unsigned char>(c)] = static_cast<index_type>(i);
+            if (Alphabet::caseInsensitive && isAsciiLetter(c)) {
+                table[static_cast<unsigned char>(c ^ 0x20)] = static_cast<index_type>(i); // the other case
+            }
+        }
+        return table;
+    }
+
+    static constexpr bool hasDistinctSymbols() {
+        std::array<bool, 256> seen{};
+        for (auto c : Alphabet::symbols) {
+            const auto folded = Alphabet::caseInsensitive && isAsciiLetter(c) ? (c | 0x20) : c;
+            if (seen[static_cast<unsigned char>(folded)]) {
+                return false;
+            }
+            seen[static_cast<unsigned char>(folded)] = true;
+        }
+        return true;
+    }
+
+    static_assert(size > 0 && size <= 256, "Alphabet must have 1 to 256 symbols");
+    static_assert(hasDistinctSymbols(), "Alphabet symbols must be distinct");
+
+public:
+    /// Index of every byte in Alphabet::symbols, \ref notASymbol for bytes outside the alphabet.
+    static constexpr std::array<index_type, 256> indexTable = makeIndexTable();
+
+    /// Return the index of \p c, throw \c std::invalid_argument if \p c is not a symbol of the alphabet.
+    static std::size_t indexOf(char c) {
+        const auto index = indexTable[static_cast<unsigned char>(c)];
+        if (index == notASymbol) {
+            throw std::invalid_argument{"Value can contain only symbols of the alphabet"};
+        }
+        return index;
+    }
+
+    /// Canonical symbol with index \p index (the case listed in Alphabet::symbols).
+    static constexpr char symbolOf(std::size_t index) noexcept {
+        return Alphabet::symbols[index];
+    }
+};
+
+} // namespace algos
+
+#endif // ALGORITHMS_ALPHABET_HPP_INCLUDED
@@ -5,118 +5,509 @@
 #ifndef ALGORITHMS_ANAGRAM_DICT_HPP_INCLUDED
 #define ALGORITHMS_ANAGRAM_DICT_HPP_INCLUDED
 
-#include <algorithm> // std::max
-#include <cassert>
-#include <cctype> // std::toupper
-//#include <functional> // std::hash, std::equal_to
-//#include <memory> // std::allocator
+#include "Alphabet.hpp"
+#include "BlockedBloomFilter.hpp"
+#include "LetterCountKernels.hpp"
+#include <algorithm> // std::sort, std::max
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional> // std::hash, std::equal_to
+#include <iterator> // std::next
+#include <memory> // std::allocator
 #include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits> // std::is_same_v
 #include <unordered_map> //TODO pimpl ?
-//#include <utility> // std::pair
+#include <utility> // std::pair
 
 namespace algos {
 
-//template <typename T> //mapped_type
-class AnagramStringKeyCalculator {
+namespace detail {
+
+/// Number of letters in the (case-insensitive) English alphabet.
+inline constexpr std::size_t alphabetSize = AlphabetTraits<AsciiLetters>::size;
+
+/// Return the letter index of \p c (0 for 'A'/'a', ..., 25 for 'Z'/'z'), throw \c std::invalid_argument if \p c is not a letter.
+inline std::size_t letterIndexOf(char c) {
+    return AlphabetTraits<AsciiLetters>::indexOf(c);
+}
+
+/// Word of an element of a run passed by forEachRun() of any of the anagram dictionaries.
+inline std::string_view wordOf(std::string_view word) noexcept {
+    return word;
+}
+
+template <typename Key>
+std::string_view wordOf(const std::pair<const Key, std::string> &entry) noexcept {
+    return entry.second;
+}
+
+} // namespace detail
+
+/// Fixed-width anagram key: the symbol counts of a word packed into 128 bits.
+/**
+ * Layout (symbol \c i is the \c i-th symbol of the key calculator's alphabet, at most 31 symbols):
+ * - \c low - 4-bit counts of symbols 0..15 (nibble \c i holds the count of symbol \c i)
+ * - \c high - 4-bit counts of symbols 16..30 in bits 0..59; the remaining bits below bit 63 are always zero
+ *
+ * When some symbol occurs more than 15 times, the counts do not fit in their nibbles.
+ * The signature then has \ref overflowFlag set in \c high and holds the full (unbounded) symbol counts:
+ * - exactly, if their Elias gamma codes (of count + 1, symbol 0 first) fit in the 126 bits below
+ *   \ref fingerprintFlag, e.g. for every word of at most 80 AsciiLetters
+ * - otherwise as a 126-bit fingerprint with \ref fingerprintFlag set
+ *
+ * Two words with different symbol counts thus get the same signature only if both are fingerprinted and
+ * their fingerprints collide: for \c n distinct fingerprinted count vectors this happens with probability
+ * at most about n^2 / 2^127.
+ */
+struct LetterCountSignature {
+    /// Bit of \c high set for signatures of words with a symbol occurring more than 15 times.
+    static constexpr std::uint64_t overflowFlag = std::uint64_t{1} << 63;
+    /// Bit of \c high set for overflow signatures holding a fingerprint of the counts instead of the counts.
+    static constexpr std::uint64_t fingerprintFlag = std::uint64_t{1} << 62;
+
+    std::uint64_t low = 0;
+    std::uint64_t high = 0;
+
+    constexpr bool overflowed() const noexcept {
+        return (high & overflowFlag) != 0;
+    }
+};
+
+constexpr inline bool operator==(const LetterCountSignature &lhs, const LetterCountSignature &rhs) noexcept {
+    // branchless, compiles to a single 128-bit comparison
+    return ((lhs.low ^ rhs.low) | (lhs.high ^ rhs.high)) == 0;
+}
+
+constexpr inline bool operator!=(const LetterCountSignature &lhs, const LetterCountSignature &rhs) noexcept {
+    return !(lhs == rhs);
+}
+
+/// Hash of LetterCountSignature: two multiplications and a fold.
+struct LetterCountSignatureHash {
+    constexpr std::size_t operator()(const LetterCountSignature &signature) const noexcept {
+        std::uint64_t h = signature.low * 0x9E3779B97F4A7C15ULL ^ signature.high * 0xC2B2AE3D27D4EB4FULL;
+        h ^= h >> 32;
+        return static_cast<std::size_t>(h);
+    }
+};
+
+/// Calculates LetterCountSignature keys. Never allocates and has no limit on symbol occurrences.
+/**
+ * \p Alphabet (see Alphabet.hpp) of at most 31 symbols defines the symbols and their nibbles;
+ * any other character makes calculateKey() throw \c std::invalid_argument.
+ * Every character costs one load from the alphabet's compile-time index table.
+ */
+template <typename Alphabet = AsciiLetters>
+class BasicAnagramSignatureKeyCalculator {
 public:
-    using key_type = std::string;
+    using key_type = LetterCountSignature;
     using mapped_type = std::string;
+    using alphabet_type = Alphabet;
+
+private:
+    using traits = AlphabetTraits<Alphabet>;
+    static constexpr std::size_t lowSymbols = 16;
+    static constexpr unsigned bitsPerSymbol = 4;
+    static constexpr std::uint64_t symbolMask = (std::uint64_t{1} << bitsPerSymbol) - 1;
+    static_assert(traits::size < 2 * lowSymbols, "LetterCountSignature holds at most 31 symbols");
 
 public:
-    //CAUTION works up to max 9 occurrences of the same letter in value!
     key_type calculateKey(const mapped_type &value) const {
-        key_type key{};
-        auto maxPos = -1;
-        for (auto letter : value) {
-            letter = static_cast<char>(std::toupper(static_cast<unsigned char>(letter)));
-            auto pos = letterPos_.at(letter);
-            if (key.size() <= pos) {
-                key.append(pos - key.size() + 1, '0');
+        return calculateKey(value.data(), value.size());
+    }
+
+    key_type calculateKey(const char *data, std::size_t size) const {
+        std::uint64_t words[2] = {0, 0};
+        for (std::size_t i = 0; i < size; ++i) {
+            const auto pos = traits::indexOf(data[i]);
+            auto &word = words[pos / lowSymbols];
+            const auto shift = (pos % lowSymbols) * bitsPerSymbol;
+            if (((word >> shift) & symbolMask) == symbolMask) {
+                return overflowKey(data, size);
             }
-            auto &valueNum = key[pos];
-            if (valueNum == '9') {
-                throw std::invalid_argument{"There can be max 9 occurrences of the same letter in value"};
+            word += std::uint64_t{1} << shift;
+        }
+        return {words[0], words[1]};
+    }
+
+    /// Calculate keys of \p count values at once.
+    /**
+     * With the AsciiLetters alphabet, short words use the SIMD kernel selected for the CPU.
+     */
+    void calculateKeys(const std::string_view *values, std::size_t count, key_type *keys) const {
+        for (std::size_t i = 0; i < count; ++i) {
+            const auto value = values[i];
+            if constexpr (std::is_same_v<Alphabet, AsciiLetters>) {
+                if (value.size() <= detail::maxShortWordSize
+                        && detail::packShortWord(value.data(), value.size(), keys[i].low, keys[i].high)) {
+                    continue;
+                }
             }
-            valueNum += 1; // ASCII encoding
-            maxPos = std::max(maxPos, static_cast<int>(pos));
+            keys[i] = calculateKey(value.data(), value.size()); // long word, other alphabet or error reporting
         }
-        assert(key.size() == static_cast<std::size_t>(maxPos) + 1);
-        return key; // NRVO (copy elision)
+    }
+
+    /// Calculate the key of a word with the symbol counts \p counts (indexed by symbol index).
+    static key_type calculateKeyOfCounts(const std::array<std::uint64_t, traits::size> &counts) noexcept {
+        key_type key;
+        for (std::size_t i = 0; i < traits::size; ++i) {
+            if (counts[i] > symbolMask) {
+                return overflowKey(counts);
+            }
+            (i < lowSymbols ? key.low : key.high) |= counts[i] << ((i % lowSymbols) * bitsPerSymbol);
+        }
+        return key;
     }
 
 private:
-    // based on English alphabet letter frequency
-    // from most to least frequent:
-    //TODO move initialization to function called by ctor; bucket_count = init_list.size()
-    //TODO proper hash function! : ascii_code(key) - ascii_code('A') % 26
-    const std::unordered_map<char, unsigned char> letterPos_ {
-        {
-            {'E', 0}, {'T', 1}, {'A', 2}, {'O', 3}, {'I', 4}, {'N', 5},
-            {'S', 6}, {'R', 7}, {'H', 8}, {'D', 9}, {'L', 10}, {'U', 11},
-            {'C', 12}, {'M', 13}, {'F', 14}, {'Y', 15}, {'W', 16}, {'G', 17},
-            {'P', 18}, {'B', 19}, {'V', 20}, {'K', 21}, {'X', 22}, {'Q', 23},
-            {'J', 24}, {'Z', 25}
-        },
-        26 // (minimal) bucket count
-    };
+    static key_type overflowKey(const char *data, std::size_t size) {
+        std::array<std::uint64_t, traits::size> counts{};
+        for (std::size_t i = 0; i < size; ++i) {
+            ++counts[traits::indexOf(data[i])];
+        }
+        return overflowKey(counts);
+    }
+
+    static key_type overflowKey(const std::array<std::uint64_t, traits::size> &counts) noexcept {
+        // exact: Elias gamma code of count + 1 for every symbol, written from bit 0 of low upwards
+        constexpr unsigned exactBits = 128 - 2; // below fingerprintFlag
+        std::uint64_t words[2] = {0, 0};
+        unsigned pos = 0;
+        for (auto count : counts) {
+            if (count >= UINT32_MAX) {
+                return fingerprintKey(counts);
+            }
+            const auto value = count + 1;
+            const auto width = static_cast<unsigned>(64 - __builtin_clzll(value));
+            const auto codeSize = 2 * width - 1; // at most 63
+            if (pos + codeSize > exactBits) {
+                return fingerprintKey(counts);
+            }
+            // width - 1 zeros, a one, the width - 1 bits of value below its leading one
+            const auto code = (((value & ((std::uint64_t{1} << (width - 1)) - 1)) << 1) | 1) << (width - 1);
+            words[pos / 64] |= code << (pos % 64);
+            if (pos % 64 + codeSize > 64) {
+                words[pos / 64 + 1] |= code >> (64 - pos % 64);
+            }
+            pos += codeSize;
+        }
+        return {words[0], words[1] | LetterCountSignature::overflowFlag};
+    }
+
+    static key_type fingerprintKey(const std::array<std::uint64_t, traits::size> &counts) noexcept {
+        // two independent 64-bit fingerprints (splitmix64 finalizer over the running state)
+        std::uint64_t h1 = 0x243F6A8885A308D3ULL, h2 = 0x13198A2E03707344ULL;
+        for (auto count : counts) {
+            h1 = mix(h1 ^ count);
+            h2 = mix(h2 + count * 0x9E3779B97F4A7C15ULL);
+        }
+        return {h1, (h2 >> 2) | LetterCountSignature::overflowFlag | LetterCountSignature::fingerprintFlag};
+    }
+
+    static constexpr std::uint64_t mix(std::uint64_t x) noexcept {
+        x += 0x9E3779B97F4A7C15ULL;
+        x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+        return x ^ (x >> 31);
+    }
 };
 
+using AnagramSignatureKeyCalculator = BasicAnagramSignatureKeyCalculator<>;
+using DigitSignatureKeyCalculator = BasicAnagramSignatureKeyCalculator<Digits>;
+
+/// Calculates string keys: the canonical symbols of the value sorted in the order of \p Alphabet.
+/**
+ * Works with alphabets of any size, e.g. Bytes. Allocates a \c std::string per key.
+ * With the default AsciiLetters it is an alternative to AnagramSignatureKeyCalculator,
+ * e.g. for debugging (keys are the upper-cased letters in alphabetical order).
+ */
+template <typename Alphabet = AsciiLetters>
+class BasicAnagramStringKeyCalculator {
+public:
+    using key_type = std::string;
+    using mapped_type = std::string;
+    using alphabet_type = Alphabet;
+
+private:
+    using traits = AlphabetTraits<Alphabet>;
+
+public:
+    key_type calculateKey(const mapped_type &value) const {
+        return calculateKey(value.data(), value.size());
+    }
+
+    key_type calculateKey(const char *data, std::size_t size) const {
+        // sort the symbol indices (< 256), then replace them by the canonical symbols
+        key_type key(size, '\0');
+        for (std::size_t i = 0; i < size; ++i) {
+            key[i] = static_cast<char>(traits::indexOf(data[i]));
+        }
+        std::sort(key.begin(), key.end(), [](char lhs, char rhs) {
+            return static_cast<unsigned char>(lhs) < static_cast<unsigned char>(rhs);
+        });
+        for (auto &c : key) {
+            c = traits::symbolOf(static_cast<unsigned char>(c));
+        }
+        return key; // NRVO (copy elision)
+    }
+};
+
+using AnagramStringKeyCalculator = BasicAnagramStringKeyCalculator<>;
+using ByteStringKeyCalculator = BasicAnagramStringKeyCalculator<Bytes>;
+
+} // namespace algos
+
+namespace std {
+
+template <>
+struct hash<algos::LetterCountSignature> : algos::LetterCountSignatureHash {};
+
+} // namespace std
+
+namespace algos {
+
+/// Key filter of BasicAnagramDict that rejects nothing; see BlockedBloomFilter for the key filter interface.
+struct NoKeyFilter {};
+
+namespace detail {
+
+// primary template handles key calculators without batch calculateKeys()
+template <typename, typename = std::void_t<> >
+struct has_batch_calculate_keys : std::false_type {};
+
+// specialization recognizes key calculators with calculateKeys(const std::string_view *, std::size_t, key_type *)
+template <typename T>
+struct has_batch_calculate_keys<T,
+        std::void_t<decltype( std::declval<const T &>().calculateKeys(
+            std::declval<const std::string_view *>(), std::size_t{}, std::declval<typename T::key_type *>()) )>
+    > : std::true_type {};
+
+template <typename T>
+inline constexpr bool has_batch_calculate_keys_v = has_batch_calculate_keys<T>::value;
+
+} // namespace detail
+
 //template <typename T, typename Container> // Container<T>
 template <
-    typename KeyCalculator = AnagramStringKeyCalculator,
-    typename Hash = std::hash<std::string>,
-    typename KeyEqual = std::equal_to<std::string>,
-    typename Allocator = std::allocator< std::pair<const std::string, std::string> >
+    typename KeyCalculator = AnagramSignatureKeyCalculator,
+    typename Hash = std::hash<typename KeyCalculator::key_type>,
+    typename KeyEqual = std::equal_to<typename KeyCalculator::key_type>,
+    typename Allocator = std::allocator< std::pair<const typename KeyCalculator::key_type,
+        typename KeyCalculator::mapped_type> >,
+    typename KeyFilter = NoKeyFilter
 > class BasicAnagramDict;
 
 //using AnagramDict = BasicAnagramDict<std::string>;
 using AnagramDict = BasicAnagramDict<>;
 
+/// AnagramDict with a BlockedBloomFilter rejecting most lookups of missing keys before probing the table.
+using FilteredAnagramDict = BasicAnagramDict<AnagramSignatureKeyCalculator, std::hash<LetterCountSignature>,
+    std::equal_to<LetterCountSignature>, std::allocator< std::pair<const LetterCountSignature, std::string> >,
+    BlockedBloomFilter>;
+
 // typename SequenceType
 //TODO remove default values from here? - are already present in forward declaration
+/**
+ * With a \p KeyFilter other than NoKeyFilter, every key is also added to the filter and findAnagrams()
+ * probes the table only if the filter may contain the key. Most lookups of missing keys then cost
+ * one cache line of the filter instead of a bucket and a node of the table.
+ * The filter is rebuilt with twice the capacity whenever it holds more keys than it was sized for.
+ */
 template <
     typename KeyCalculator,
     typename Hash,
     typename KeyEqual,
-    typename Allocator
+    typename Allocator,
+    typename KeyFilter
 > class BasicAnagramDict {
+public:
+    using key_type = typename KeyCalculator::key_type;
+    using mapped_type = typename KeyCalculator::mapped_type;
+    using key_calculator_type = KeyCalculator;
+
 private:
-    using underlying_container = std::unordered_multimap<std::string, std::string,
+    using underlying_container = std::unordered_multimap<key_type, mapped_type,
         Hash, KeyEqual, Allocator>;
 
 public:
-    using key_type = std::string;
-    using mapped_type = std::string;
     using value_type = std::pair<const key_type, mapped_type>;
     using iterator = typename underlying_container::iterator;
     using const_iterator = typename underlying_container::const_iterator;
     // local_iterator ?
 
+private:
+    static constexpr bool hasKeyFilter = !std::is_same_v<KeyFilter, NoKeyFilter>;
+
 public:
+    BasicAnagramDict() = default;
+
+    /// Use \p keyFilter (empty, its bits per key are kept when it is rebuilt) as the key filter.
+    explicit BasicAnagramDict(KeyFilter keyFilter)
+        : keyFilter_(std::move(keyFilter)) {}
+
     //TODO can I move definitions to .cpp file?
     std::pair<const_iterator, const_iterator> findAnagrams(const mapped_type &value) const {
         auto key = keyCalculator_.calculateKey(value);
+        if constexpr (hasKeyFilter) {
+            if (!keyFilter_.mayContain(multimap_.hash_function()(key))) {
+                return {multimap_.end(), multimap_.end()};
+            }
+        }
         return multimap_.equal_range(key);
     }
 
+    /// Look up a batch of values: write \c findAnagrams(*it) for every \c it in [first, last) to \p out.
+    /**
+     * Values are processed in blocks: keys of the whole block are calculated first
+     * (with the SIMD kernels if the key calculator has \c calculateKeys()), then the buckets of all the block's
+     * keys are looked up and their first nodes prefetched, and only then the keys' ranges are found,
+     * so the cache misses of the block overlap.
+     *
+     * \tparam InputIt input iterator whose value is convertible to \c std::string_view
+     * \tparam OutputIt output iterator accepting \c std::pair<const_iterator, const_iterator>
+     * \return \p out past the last written result
+     */
+    template <typename InputIt, typename OutputIt>
+    OutputIt findAnagramsBatch(InputIt first, InputIt last, OutputIt out) const {
+        constexpr std::size_t blockSize = 32;
+        std::string_view values[blockSize];
+        key_type keys[blockSize];
+        bool rejected[blockSize] = {}; // by the key filter
+        while (first != last) {
+            std::size_t count = 0;
+            for (; count < blockSize && first != last; ++first) {
+                values[count++] = *first;
+            }
+            if constexpr (detail::has_batch_calculate_keys_v<KeyCalculator>) {
+                keyCalculator_.calculateKeys(values, count, keys);
+            } else {
+                for (std::size_t i = 0; i < count; ++i) {
+                    keys[i] = keyCalculator_.calculateKey(mapped_type(values[i]));
+                }
+            }
+            for (std::size_t i = 0; i < count; ++i) {
+                if constexpr (hasKeyFilter) {
+                    rejected[i] = !keyFilter_.mayContain(multimap_.hash_function()(keys[i]));
+                    if (rejected[i]) {
+                        continue;
+                    }
+                }
+                const auto bucket = multimap_.bucket(keys[i]);
+                const auto node = multimap_.cbegin(bucket);
+                if (node != multimap_.cend(bucket)) {
+                    __builtin_prefetch(&*node);
+                }
+            }
+            for (std::size_t i = 0; i < count; ++i) {
+                if (hasKeyFilter && rejected[i]) {
+                    *out++ = std::pair<const_iterator, const_iterator>{multimap_.end(), multimap_.end()};
+                } else {
+                    *out++ = multimap_.equal_range(keys[i]);
+                }
+            }
+        }
+        return out;
+    }
+
     // cannot emplace() because we need to construct mapped_type for key calculation!
 
     //TODO std::pair<iterator,bool>
     iterator insert(const mapped_type &value) {
         //TODO if this string already exists - do not add (like in set)
         auto key = keyCalculator_.calculateKey(value);
-        return multimap_.insert({std::move(key), value});
+        auto it = multimap_.insert({std::move(key), value});
+        addToKeyFilter(it->first);
+        return it;
     }
 
     //TODO std::pair<iterator,bool>
     iterator insert(mapped_type &&value) {
         auto key = keyCalculator_.calculateKey(value);
-        return multimap_.insert({std::move(key), std::move(value)});
+        auto it = multimap_.insert({std::move(key), std::move(value)});
+        addToKeyFilter(it->first);
+        return it;
+    }
+
+    const_iterator begin() const noexcept {
+        return multimap_.begin();
+    }
+
+    const_iterator end() const noexcept {
+        return multimap_.end();
+    }
+
+    /// Number of words stored.
+    std::size_t size() const noexcept {
+        return multimap_.size();
+    }
+
+    /// Call \p fn(key, first, last) for every key, where [first, last) is the range of its entries.
+    template <typename Function>
+    void forEachRun(Function fn) const {
+        // elements with equivalent keys are adjacent in the iteration order of unordered_multimap
+        for (auto first = multimap_.begin(); first != multimap_.end();) {
+            auto last = std::next(first, multimap_.count(first->first));
+            fn(first->first, first, last);
+            first = last;
+        }
+    }
+
+    /// Key filter in front of the table, e.g. for its falsePositiveRate() and memoryUsage().
+    const KeyFilter &keyFilter() const noexcept {
+        return keyFilter_;
+    }
+
+    /// Estimated bytes of heap memory owned by the dictionary.
+    /**
+     * Counts the bucket array, one node per entry (next pointer, cached hash and the value),
+     * the heap buffers of keys and values that do not fit in the small string buffer
+     * and the key filter. Allocator overhead is not included.
+     *
+     * Complexity: O(n) (visits every entry)
+     */
+    std::size_t memoryUsage() const noexcept {
+        std::size_t bytes = multimap_.bucket_count() * sizeof(void *)
+            + multimap_.size() * (sizeof(void *) + sizeof(std::size_t) + sizeof(value_type));
+        for (const auto &[key, value] : multimap_) {
+            bytes += heapBytes(key) + heapBytes(value);
+        }
+        if constexpr (hasKeyFilter) {
+            bytes += keyFilter_.memoryUsage();
+        }
+        return bytes;
+    }
+
+private:
+    void addToKeyFilter(const key_type &key) {
+        if constexpr (hasKeyFilter) {
+            keyFilter_.insert(multimap_.hash_function()(key));
+            if (keyFilter_.size() > keyFilter_.capacity()) {
+                KeyFilter grown{keyFilter_.bitsPerKey(), std::max<std::size_t>(2 * keyFilter_.capacity(), 64)};
+                forEachRun([&](const key_type &runKey, const_iterator, const_iterator) {
+                    grown.insert(multimap_.hash_function()(runKey));
+                });
+                keyFilter_ = std::move(grown);
+            }
+        }
+    }
+
+    template <typename T>
+    static std::size_t heapBytes(const T &) noexcept {
+        return 0;
+    }
+
+    static std::size_t heapBytes(const std::string &str) noexcept {
+        // empty string's capacity is the capacity of its small string buffer
+        return str.capacity() > std::string{}.capacity() ? str.capacity() + 1 : 0;
     }
 
 private:
     KeyCalculator keyCalculator_;
     underlying_container multimap_;
+    KeyFilter keyFilter_;
 };
 
 } // namespace algos
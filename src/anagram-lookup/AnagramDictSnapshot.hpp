@@ -0,0 +1,304 @@
+/** \file
+ * \brief Memory-mappable immutable snapshot of an anagram dictionary.
+ */
+
+#ifndef ALGORITHMS_ANAGRAM_DICT_SNAPSHOT_HPP_INCLUDED
+#define ALGORITHMS_ANAGRAM_DICT_SNAPSHOT_HPP_INCLUDED
+
+#include "../common/MappedFile.hpp"
+#include "AnagramDict.hpp"
+#include "FlatAnagramDict.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <cstring> // std::memcmp, std::memcpy
+#include <fstream>
+#include <functional> // std::hash, std::equal_to
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility> // std::pair
+#include <vector>
+
+namespace algos {
+
+namespace detail {
+
+/// Snapshot file header, followed by the slot table, the word references and the arena.
+/**
+ * All sections start at offsets aligned to \ref snapshotAlignment.
+ * Integers are stored in the native byte order; \c byteOrderMark detects files written on a different one.
+ */
+struct SnapshotHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t byteOrderMark;
+    std::uint32_t keySize;
+    std::uint32_t slotSize;
+    std::uint64_t emptyKeyHash; // detects snapshots written with a different hash function
+    std::uint64_t alphabetId; // detects snapshots written with a different alphabet, see snapshotAlphabetId()
+    std::uint64_t slotBits;
+    std::uint64_t keyCount;
+    std::uint64_t wordCount;
+    std::uint64_t arenaSize;
+    std::uint64_t slotsOffset;
+    std::uint64_t refsOffset;
+    std::uint64_t arenaOffset;
+    std::uint64_t fileSize;
+};
+
+inline constexpr char snapshotMagic[8] = {'A', 'N', 'A', 'G', 'S', 'N', 'A', 'P'};
+inline constexpr std::uint32_t snapshotVersion = 3;
+inline constexpr std::uint32_t snapshotByteOrderMark = 0x01020304;
+inline constexpr std::uint64_t snapshotAlignment = 64;
+/// Limits of the word references (offset << lengthBits | length) and of the runs' 32-bit bounds.
+inline constexpr std::uint64_t snapshotMaxWordSize = WordRunIterator::lengthMask;
+inline constexpr std::uint64_t snapshotMaxArenaSize = std::uint64_t{1} << (64 - WordRunIterator::lengthBits);
+inline constexpr std::uint64_t snapshotMaxWordCount = UINT32_MAX;
+
+/// Slot of the snapshot's open-addressing table. An empty slot has \c runSize == 0.
+template <typename Key>
+struct SnapshotSlot {
+    Key key;
+    std::uint32_t runBegin;
+    std::uint32_t runSize;
+};
+
+template <typename KeyCalculator, typename = void>
+struct has_alphabet : std::false_type {};
+
+template <typename KeyCalculator>
+struct has_alphabet<KeyCalculator, std::void_t<typename KeyCalculator::alphabet_type> > : std::true_type {};
+
+/// Identifier of the alphabet of \p KeyCalculator: FNV-1a hash of its AlphabetTraits::indexTable
+/// (symbols, their order and case folding), the FNV offset basis for key calculators without \c alphabet_type.
+template <typename KeyCalculator>
+constexpr std::uint64_t snapshotAlphabetId() noexcept {
+    std::uint64_t id = 0xCBF29CE484222325ULL;
+    if constexpr (has_alphabet<KeyCalculator>::value) {
+        for (const auto index : AlphabetTraits<typename KeyCalculator::alphabet_type>::indexTable) {
+            id = (id ^ index) * 0x100000001B3ULL;
+        }
+    }
+    return id;
+}
+
+constexpr std::uint64_t alignUp(std::uint64_t offset) noexcept {
+    return (offset + snapshotAlignment - 1) / snapshotAlignment * snapshotAlignment;
+}
+
+} // namespace detail
+
+/// Write \p dict to \p path in the snapshot format read by BasicAnagramDictSnapshot.
+/**
+ * \tparam Dict BasicAnagramDict or BasicFlatAnagramDict instantiation
+ *   whose \c key_type is trivially copyable (e.g. LetterCountSignature)
+ * \tparam Hash hash used by the table in the snapshot, must be the same as the reader's
+ *
+ * Throws \c std::runtime_error if the file cannot be written, \c std::length_error (before creating the file)
+ * if a word is 2^24 bytes or longer, the words total more than 2^40 bytes or there are 2^32 words or more.
+ */
+template <typename Dict, typename Hash = std::hash<typename Dict::key_type> >
+void saveSnapshot(const Dict &dict, const std::string &path) {
+    using key_type = typename Dict::key_type;
+    using Slot = detail::SnapshotSlot<key_type>;
+    static_assert(std::is_trivially_copyable_v<key_type>, "Snapshot keys are stored as raw bytes");
+
+    // pass 1: slot table and word references
+    std::size_t keyCount = 0;
+    dict.forEachRun([&](const key_type &, auto, auto) { ++keyCount; });
+    std::uint64_t slotBits = 4;
+    while (keyCount * 4 > (std::uint64_t{1} << slotBits) * 3) { // max load factor 3/4
+        ++slotBits;
+    }
+    const auto mask = (std::uint64_t{1} << slotBits) - 1;
+    std::vector<Slot> slots(mask + 1, Slot{});
+    std::vector<std::uint64_t> refs;
+    std::uint64_t arenaSize = 0;
+    Hash hash;
+    dict.forEachRun([&](const key_type &key, auto first, auto last) {
+        auto index = (static_cast<std::uint64_t>(hash(key)) * 0x9E3779B97F4A7C15ULL) >> (64 - slotBits);
+        while (slots[index].runSize != 0) {
+            index = (index + 1) & mask;
+        }
+        slots[index].key = key;
+        slots[index].runBegin = static_cast<std::uint32_t>(refs.size());
+        for (; first != last; ++first) {
+            const auto word = detail::wordOf(*first);
+            if (word.size() > detail::snapshotMaxWordSize) {
+                throw std::length_error{"Word too long for an anagram dictionary snapshot"};
+            }
+            if (arenaSize + word.size() > detail::snapshotMaxArenaSize) {
+                throw std::length_error{"Anagram dictionary snapshot arena size limit exceeded"};
+            }
+            if (refs.size() == detail::snapshotMaxWordCount) {
+                throw std::length_error{"Anagram dictionary snapshot word count limit exceeded"};
+            }
+            refs.push_back((arenaSize << WordRunIterator::lengthBits) | word.size());
+            arenaSize += word.size();
+        }
+        slots[index].runSize = static_cast<std::uint32_t>(refs.size() - slots[index].runBegin);
+    });
+
+    detail::SnapshotHeader header{};
+    std::memcpy(header.magic, detail::snapshotMagic, sizeof header.magic);
+    header.version = detail::snapshotVersion;
+    header.byteOrderMark = detail::snapshotByteOrderMark;
+    header.keySize = sizeof(key_type);
+    header.slotSize = sizeof(Slot);
+    header.emptyKeyHash = hash(key_type{});
+    header.alphabetId = detail::snapshotAlphabetId<typename Dict::key_calculator_type>();
+    header.slotBits = slotBits;
+    header.keyCount = keyCount;
+    header.wordCount = refs.size();
+    header.arenaSize = arenaSize;
+    header.slotsOffset = detail::alignUp(sizeof header);
+    header.refsOffset = detail::alignUp(header.slotsOffset + slots.size() * sizeof(Slot));
+    header.arenaOffset = detail::alignUp(header.refsOffset + refs.size() * sizeof(std::uint64_t));
+    header.fileSize = header.arenaOffset + arenaSize;
+
+    std::ofstream file{path, std::ios::binary | std::ios::trunc};
+    const auto writeAt = [&file](std::uint64_t offset, const void *data, std::size_t size) {
+        static constexpr char padding[detail::snapshotAlignment] = {};
+        const auto pos = static_cast<std::uint64_t>(file.tellp());
+        file.write(padding, static_cast<std::streamsize>(offset - pos));
+        file.write(static_cast<const char *>(data), static_cast<std::streamsize>(size));
+    };
+    writeAt(0, &header, sizeof header);
+    writeAt(header.slotsOffset, slots.data(), slots.size() * sizeof(Slot));
+    writeAt(header.refsOffset, refs.data(), refs.size() * sizeof(std::uint64_t));
+    // pass 2: words, in the order of their references
+    writeAt(header.arenaOffset, nullptr, 0);
+    dict.forEachRun([&](const key_type &, auto first, auto last) {
+        for (; first != last; ++first) {
+            const auto word = detail::wordOf(*first);
+            file.write(word.data(), static_cast<std::streamsize>(word.size()));
+        }
+    });
+    if (!file.flush()) {
+        throw std::runtime_error{"Cannot write snapshot " + path};
+    }
+}
+
+template <
+    typename KeyCalculator = AnagramSignatureKeyCalculator,
+    typename Hash = std::hash<typename KeyCalculator::key_type>,
+    typename KeyEqual = std::equal_to<typename KeyCalculator::key_type>
+> class BasicAnagramDictSnapshot;
+
+using AnagramDictSnapshot = BasicAnagramDictSnapshot<>;
+
+/// Read-only anagram dictionary queried directly in a memory-mapped snapshot file.
+/**
+ * Loading maps the file and validates only the header, so it takes constant time regardless of
+ * the dictionary size and does not allocate per entry. Pages are loaded lazily by queries and are
+ * shared between all processes mapping the same file.
+ *
+ * findAnagrams() returns the same words as the dictionary the snapshot was saved from,
+ * in the order of the dictionary's runs.
+ *
+ * \warning The snapshot contents are trusted: only the header and the queried run's bounds are checked.
+ */
+template <
+    typename KeyCalculator,
+    typename Hash,
+    typename KeyEqual
+> class BasicAnagramDictSnapshot {
+public:
+    using key_type = typename KeyCalculator::key_type;
+    using mapped_type = typename KeyCalculator::mapped_type;
+    using key_calculator_type = KeyCalculator;
+    using value_type = std::string_view;
+    using size_type = std::size_t;
+    using const_iterator = WordRunIterator;
+    using iterator = const_iterator;
+
+private:
+    using Slot = detail::SnapshotSlot<key_type>;
+    static_assert(std::is_trivially_copyable_v<key_type>, "Snapshot keys are stored as raw bytes");
+
+public:
+    /// Map the snapshot file at \p path. Throws \c std::runtime_error if it is not a valid snapshot
+    /// or was saved with a different key size, hash function or alphabet.
+    explicit BasicAnagramDictSnapshot(const std::string &path)
+        : file_(path) {
+        detail::SnapshotHeader header;
+        if (file_.size() < sizeof header) {
+            throw std::runtime_error{"Not an anagram dictionary snapshot: " + path};
+        }
+        std::memcpy(&header, file_.data(), sizeof header);
+        if (std::memcmp(header.magic, detail::snapshotMagic, sizeof header.magic) != 0
+                || header.byteOrderMark != detail::snapshotByteOrderMark) {
+            throw std::runtime_error{"Not an anagram dictionary snapshot: " + path};
+        }
+        if (header.version != detail::snapshotVersion || header.keySize != sizeof(key_type)
+                || header.slotSize != sizeof(Slot) || header.emptyKeyHash != hash_(key_type{})
+                || header.alphabetId != detail::snapshotAlphabetId<KeyCalculator>()) {
+            throw std::runtime_error{"Incompatible anagram dictionary snapshot: " + path};
+        }
+        const std::uint64_t slotCount = header.slotBits < 48 ? std::uint64_t{1} << header.slotBits : 0;
+        if (slotCount < 2 || header.fileSize != file_.size()
+                || header.slotsOffset + slotCount * sizeof(Slot) > header.refsOffset
+                || header.refsOffset + header.wordCount * sizeof(std::uint64_t) > header.arenaOffset
+                || header.arenaOffset + header.arenaSize != header.fileSize
+                || header.slotsOffset % alignof(Slot) != 0 || header.refsOffset % alignof(std::uint64_t) != 0) {
+            throw std::runtime_error{"Corrupted anagram dictionary snapshot: " + path};
+        }
+        slots_ = reinterpret_cast<const Slot *>(file_.data() + header.slotsOffset);
+        refs_ = reinterpret_cast<const std::uint64_t *>(file_.data() + header.refsOffset);
+        arena_ = file_.data() + header.arenaOffset;
+        slotBits_ = static_cast<unsigned>(header.slotBits);
+        keyCount_ = header.keyCount;
+        wordCount_ = header.wordCount;
+    }
+
+    std::pair<const_iterator, const_iterator> findAnagrams(const mapped_type &value) const {
+        const auto key = keyCalculator_.calculateKey(value);
+        const auto mask = (size_type{1} << slotBits_) - 1;
+        auto index = static_cast<size_type>(
+            (static_cast<std::uint64_t>(hash_(key)) * 0x9E3779B97F4A7C15ULL) >> (64 - slotBits_));
+        for (; slots_[index].runSize != 0; index = (index + 1) & mask) {
+            const auto &slot = slots_[index];
+            if (keyEqual_(slot.key, key)) {
+                if (std::uint64_t{slot.runBegin} + slot.runSize > wordCount_) {
+                    throw std::runtime_error{"Corrupted anagram dictionary snapshot"};
+                }
+                const auto *run = refs_ + slot.runBegin;
+                return {const_iterator{run, arena_}, const_iterator{run + slot.runSize, arena_}};
+            }
+        }
+        return {const_iterator{}, const_iterator{}};
+    }
+
+    /// Number of words stored.
+    size_type size() const noexcept {
+        return wordCount_;
+    }
+
+    /// Number of distinct keys (anagram classes) stored.
+    size_type keyCount() const noexcept {
+        return keyCount_;
+    }
+
+    /// Size of the mapped file; the memory is shared with other processes mapping the same file.
+    std::size_t mappedSize() const noexcept {
+        return file_.size();
+    }
+
+private:
+    MappedFile file_;
+    KeyCalculator keyCalculator_;
+    Hash hash_;
+    KeyEqual keyEqual_;
+
+    const Slot *slots_ = nullptr;
+    const std::uint64_t *refs_ = nullptr;
+    const char *arena_ = nullptr;
+    unsigned slotBits_ = 0;
+    size_type keyCount_ = 0;
+    size_type wordCount_ = 0;
+};
+
+} // namespace algos
+
+#endif // ALGORITHMS_ANAGRAM_DICT_SNAPSHOT_HPP_INCLUDED
@@ -0,0 +1,302 @@
+/** \file
+ * \brief AnagramScanner implementation.
+ */
+
+#ifndef ALGORITHMS_ANAGRAM_SCANNER_HPP_INCLUDED
+#define ALGORITHMS_ANAGRAM_SCANNER_HPP_INCLUDED
+
+#include "AnagramDict.hpp"
+#include "BlockedBloomFilter.hpp"
+#include <algorithm> // std::sort, std::stable_sort, std::unique
+#include <array>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <system_error>
+#include <utility> // std::pair
+#include <vector>
+
+#include <unistd.h> // read
+
+namespace algos {
+
+/// A window of the scanned text that is an anagram of some dictionary words.
+struct AnagramOccurrence {
+    std::uint64_t offset; ///< of the window's first byte from the start of the stream
+    std::size_t length;
+    const std::string_view *firstMatch; ///< [firstMatch, lastMatch) - the dictionary words
+    const std::string_view *lastMatch;
+
+    const std::string_view *begin() const noexcept {
+        return firstMatch;
+    }
+
+    const std::string_view *end() const noexcept {
+        return lastMatch;
+    }
+};
+
+template <typename Alphabet = AsciiLetters>
+class BasicAnagramScanner;
+
+using AnagramScanner = BasicAnagramScanner<>;
+
+/// Finds every window of a text stream that is an anagram of a word of a dictionary.
+/**
+ * For every distinct word length L of the dictionary, the scanner slides a window of length L
+ * over the stream and keeps the window's LetterCountSignature up to date in O(1) per byte:
+ * the incoming symbol's nibble is incremented, the outgoing one's decremented. The signature is
+ * then checked by a BlockedBloomFilter and, rarely, by the scanner's own table of the dictionary's keys.
+ * Windows containing a byte outside \p Alphabet never match. The words are grouped by their
+ * signatures over \p Alphabet, whatever key calculator the dictionary uses.
+ *
+ * - Time: O(n * d) where n is the length of the stream and d the number of distinct word lengths
+ * - Memory: O(longest word) of stream state, independent of the stream's length
+ *
+ * The stream can be fed in chunks by repeated scan() calls; occurrences spanning chunk
+ * boundaries are found too. Occurrences are reported in the order of their end offsets,
+ * shorter ones first.
+ *
+ * \note The scanner refers to the words stored in the dictionary it was built from:
+ *   the dictionary must outlive the scanner and must not be modified.
+ */
+template <typename Alphabet>
+class BasicAnagramScanner {
+public:
+    using key_calculator_type = BasicAnagramSignatureKeyCalculator<Alphabet>;
+
+private:
+    using traits = AlphabetTraits<Alphabet>;
+    using index_type = typename traits::index_type;
+    using Counts = std::array<std::uint64_t, traits::size>;
+
+public:
+    /// Build the scanner for the words of \p dict (any dictionary providing forEachRun()).
+    /**
+     * Throws \c std::invalid_argument if a word contains a character outside \p Alphabet.
+     */
+    template <typename Dict>
+    explicit BasicAnagramScanner(const Dict &dict)
+        : filter_(10, 0) {
+        // the dictionary's key calculator may group words differently (e.g. case-sensitively): regroup them
+        std::vector<std::pair<LetterCountSignature, std::string_view> > entries;
+        dict.forEachRun([&](const auto &, auto first, auto last) {
+            const auto word = detail::wordOf(*first);
+            const auto key = keyCalculator_.calculateKey(word.data(), word.size());
+            for (; first != last; ++first) {
+                entries.emplace_back(key, detail::wordOf(*first));
+            }
+        });
+        std::stable_sort(entries.begin(), entries.end(), [](const auto &lhs, const auto &rhs) {
+            return lhs.first.high != rhs.first.high ? lhs.first.high < rhs.first.high : lhs.first.low < rhs.first.low;
+        });
+        std::vector<std::size_t> lengths;
+        for (std::size_t i = 0; i < entries.size(); ++i) {
+            if (i == 0 || entries[i].first != entries[i - 1].first) {
+                runs_.push_back({entries[i].first, static_cast<std::uint32_t>(i), 0});
+                lengths.push_back(entries[i].second.size());
+            }
+            ++runs_.back().wordCount;
+            words_.push_back(entries[i].second);
+        }
+        std::sort(lengths.begin(), lengths.end());
+        lengths.erase(std::unique(lengths.begin(), lengths.end()), lengths.end());
+        if (!lengths.empty() && lengths.front() == 0) {
+            lengths.erase(lengths.begin()); // the empty word is not reported
+        }
+        for (auto length : lengths) {
+            windows_.push_back({length});
+        }
+
+        filter_ = BlockedBloomFilter{10, runs_.size()};
+        slotBits_ = 1;
+        while ((std::size_t{1} << slotBits_) < 2 * runs_.size()) { // max load factor 1/2
+            ++slotBits_;
+        }
+        slots_.assign(std::size_t{1} << slotBits_, emptySlot);
+        for (std::uint32_t i = 0; i < runs_.size(); ++i) {
+            const auto hash = hash_(runs_[i].key);
+            filter_.insert(hash);
+            auto index = bucketOf(hash);
+            while (slots_[index] != emptySlot) {
+                index = (index + 1) & (slots_.size() - 1);
+            }
+            slots_[index] = i;
+        }
+
+        std::size_t ringSize = 1;
+        while (ringSize <= (lengths.empty() ? 0 : lengths.back())) { // the current byte and a whole window before it
+            ringSize *= 2;
+        }
+        ring_.resize(ringSize);
+    }
+
+    /// Forget the stream scanned so far; the next scan() starts a new stream at offset 0.
+    void reset() noexcept {
+        position_ = 0;
+        invalidEnd_ = 0;
+        for (auto &window : windows_) {
+            window = Window{window.length};
+        }
+    }
+
+    /// Scan the next chunk [first, last) of the stream, call \p fn(const AnagramOccurrence &) for every occurrence.
+    template <typename InputIt, typename Function>
+    void scan(InputIt first, InputIt last, Function fn) {
+        // the state lives in locals: stores to the byte-sized ring may alias any member
+        auto position = position_;
+        auto invalidEnd = invalidEnd_;
+        auto *const ring = ring_.data();
+        const auto ringMask = ring_.size() - 1;
+        auto *const windowsBegin = windows_.data();
+        auto *const windowsEnd = windowsBegin + windows_.size();
+        for (; first != last; ++first, ++position) {
+            const auto index = traits::indexTable[static_cast<unsigned char>(*first)];
+            ring[position & ringMask] = index;
+            if (index == traits::notASymbol) {
+                invalidEnd = position + 1;
+            }
+            for (auto *window = windowsBegin; window != windowsEnd; ++window) {
+                const auto length = window->length;
+                add(*window, index);
+                if (position >= length) {
+                    remove(*window, ring[(position - length) & ringMask]);
+                }
+                if (invalidEnd + length <= position + 1) { // a whole window of symbols
+                    report(*window, position + 1 - length, fn);
+                }
+            }
+        }
+        position_ = position;
+        invalidEnd_ = invalidEnd;
+    }
+
+    /// Scan the rest of the stream read from the file descriptor \p fd, in constant memory.
+    /**
+     * Throws \c std::system_error if reading fails.
+     */
+    template <typename Function>
+    void scan(int fd, Function fn) {
+        std::vector<char> buffer(readChunkSize);
+        for (;;) {
+            const auto bytesRead = ::read(fd, buffer.data(), buffer.size());
+            if (bytesRead == 0) {
+                return;
+            }
+            if (bytesRead < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                throw std::system_error{errno, std::generic_category(), "Cannot read the scanned stream"};
+            }
+            scan(buffer.data(), buffer.data() + bytesRead, fn);
+        }
+    }
+
+    /// Number of bytes of the stream scanned so far.
+    std::uint64_t offset() const noexcept {
+        return position_;
+    }
+
+    /// Bytes of heap memory owned by the scanner (the key table, the filter and the stream state).
+    std::size_t memoryUsage() const noexcept {
+        return words_.capacity() * sizeof(std::string_view) + runs_.capacity() * sizeof(Run)
+            + slots_.capacity() * sizeof(std::uint32_t) + filter_.memoryUsage()
+            + windows_.capacity() * sizeof(Window) + ring_.capacity() * sizeof(index_type);
+    }
+
+private:
+    static constexpr std::size_t readChunkSize = 1 << 16;
+    static constexpr std::uint32_t emptySlot = UINT32_MAX;
+    static constexpr std::size_t lowSymbols = 16;
+    static constexpr std::uint64_t nibbleMask = 15;
+
+    struct Run {
+        LetterCountSignature key;
+        std::uint32_t firstWord;
+        std::uint32_t wordCount;
+    };
+
+    /// Rolling state of the windows of one length.
+    struct Window {
+        std::size_t length;
+        LetterCountSignature signature{}; // nibbles of counts up to 15; valid if overflowCount == 0
+        std::size_t overflowCount = 0; // number of symbols occurring more than 15 times
+        Counts counts{}; // exact counts, kept only for windows longer than 15
+    };
+
+    std::size_t bucketOf(std::uint64_t hash) const noexcept {
+        return static_cast<std::size_t>((hash * 0x9E3779B97F4A7C15ULL) >> (64 - slotBits_));
+    }
+
+    /// Signature increment of every symbol index (a single nibble), zero for traits::notASymbol.
+    static constexpr std::array<LetterCountSignature, 256> makeIncrements() {
+        std::array<LetterCountSignature, 256> increments{};
+        for (std::size_t i = 0; i < traits::size; ++i) {
+            (i < lowSymbols ? increments[i].low : increments[i].high) = std::uint64_t{1} << ((i % lowSymbols) * 4);
+        }
+        return increments;
+    }
+
+    static constexpr std::array<LetterCountSignature, 256> increments = makeIncrements();
+
+    // branch-free for windows of up to 15 symbols: which of the two words a random symbol hits is unpredictable
+    static void add(Window &window, index_type index) noexcept {
+        if (window.length > nibbleMask && index != traits::notASymbol) {
+            const auto count = ++window.counts[index];
+            if (count > nibbleMask) {
+                window.overflowCount += count == nibbleMask + 1;
+                return; // the nibble stays at 15
+            }
+        }
+        window.signature.low += increments[index].low;
+        window.signature.high += increments[index].high;
+    }
+
+    static void remove(Window &window, index_type index) noexcept {
+        if (window.length > nibbleMask && index != traits::notASymbol) {
+            const auto count = window.counts[index]--;
+            if (count > nibbleMask) {
+                window.overflowCount -= count == nibbleMask + 1;
+                return;
+            }
+        }
+        window.signature.low -= increments[index].low;
+        window.signature.high -= increments[index].high;
+    }
+
+    template <typename Function>
+    void report(const Window &window, std::uint64_t offset, Function &fn) const {
+        const auto key = window.overflowCount == 0
+            ? window.signature : key_calculator_type::calculateKeyOfCounts(window.counts);
+        const std::uint64_t hash = hash_(key);
+        if (!filter_.mayContain(hash)) {
+            return;
+        }
+        for (auto index = bucketOf(hash); slots_[index] != emptySlot; index = (index + 1) & (slots_.size() - 1)) {
+            const auto &run = runs_[slots_[index]];
+            if (run.key == key) {
+                const auto *first = words_.data() + run.firstWord;
+                fn(AnagramOccurrence{offset, window.length, first, first + run.wordCount});
+                return;
+            }
+        }
+    }
+
+    key_calculator_type keyCalculator_;
+    LetterCountSignatureHash hash_;
+    std::vector<std::string_view> words_;
+    std::vector<Run> runs_;
+    std::vector<std::uint32_t> slots_; // open-addressing table of indices to runs_
+    unsigned slotBits_ = 1;
+    BlockedBloomFilter filter_;
+    std::vector<Window> windows_;
+    std::vector<index_type> ring_; // symbol indices of the last bytes
+    std::uint64_t position_ = 0;
+    std::uint64_t invalidEnd_ = 0; // one past the last byte outside the alphabet
+};
+
+} // namespace algos
+
+#endif // ALGORITHMS_ANAGRAM_SCANNER_HPP_INCLUDED
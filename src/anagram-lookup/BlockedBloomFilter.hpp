@@ -0,0 +1,156 @@
+/** \file
+ * \brief BlockedBloomFilter implementation.
+ */
+
+#ifndef ALGORITHMS_BLOCKED_BLOOM_FILTER_HPP_INCLUDED
+#define ALGORITHMS_BLOCKED_BLOOM_FILTER_HPP_INCLUDED
+
+#include <algorithm> // std::clamp
+#include <array>
+#include <cmath> // std::lround
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <utility> // std::pair
+#include <vector>
+
+namespace algos {
+
+/// Blocked Bloom filter over 64-bit key hashes; a key filter of BasicAnagramDict.
+/**
+ * Every key sets \ref hashCount bits in a single 64-byte block (one cache line) chosen by its hash,
+ * so both insert() and mayContain() touch one cache line. Compared to a classic Bloom filter,
+ * blocks fill unevenly, which costs a slightly higher false-positive rate at the same memory.
+ *
+ * The filter is sized for capacity() keys at bitsPerKey() bits each (rounded up to whole blocks,
+ * a power of two of them); the owner rebuilds it with a larger capacity when size() exceeds capacity().
+ *
+ * Key filter interface used by BasicAnagramDict:
+ * - <tt>KeyFilter(double bitsPerKey, std::size_t capacity)</tt>
+ * - <tt>bool insert(std::uint64_t hash)</tt>, <tt>bool mayContain(std::uint64_t hash) const</tt>
+ * - <tt>size()</tt>, <tt>capacity()</tt>, <tt>bitsPerKey()</tt>, <tt>memoryUsage()</tt>
+ */
+class BlockedBloomFilter {
+public:
+    static constexpr std::size_t blockBits = 512;
+
+    /// Filter for \p capacity keys (at least one block) with \p bitsPerKey bits per key.
+    explicit BlockedBloomFilter(double bitsPerKey = 10, std::size_t capacity = 0)
+        : bitsPerKey_(bitsPerKey),
+        hashCount_(static_cast<unsigned>(std::clamp(std::lround(bitsPerKey * 0.6931471805599453), 1L, 16L))),
+        capacity_(capacity) {
+        if (!(bitsPerKey >= 1 && bitsPerKey <= 64)) {
+            throw std::invalid_argument{"Bits per key must be between 1 and 64"};
+        }
+        const auto minBlocks = static_cast<double>(capacity) * bitsPerKey / blockBits;
+        while (static_cast<double>(std::size_t{1} << blockCountBits_) < minBlocks) {
+            ++blockCountBits_;
+        }
+        blocks_.resize(std::size_t{1} << blockCountBits_);
+    }
+
+    /// Add the key with hash \p hash.
+    /**
+     * \return \c true if the filter could not contain the key before (then it counts in size())
+     */
+    bool insert(std::uint64_t hash) noexcept {
+        auto &block = blocks_[blockOf(hash)];
+        const auto [first, step] = bitSequence(hash);
+        bool added = false;
+        for (unsigned i = 0; i < hashCount_; ++i) {
+            const auto bit = (first + i * step) % blockBits;
+            const auto mask = std::uint64_t{1} << (bit % 64);
+            added |= (block.words[bit / 64] & mask) == 0;
+            block.words[bit / 64] |= mask;
+        }
+        size_ += added;
+        return added;
+    }
+
+    /// Return \c false if the key with hash \p hash has certainly not been inserted.
+    bool mayContain(std::uint64_t hash) const noexcept {
+        const auto &block = blocks_[blockOf(hash)];
+        const auto [first, step] = bitSequence(hash);
+        bool contains = true;
+        for (unsigned i = 0; i < hashCount_; ++i) {
+            const auto bit = (first + i * step) % blockBits;
+            contains &= (block.words[bit / 64] >> (bit % 64)) & 1;
+        }
+        return contains;
+    }
+
+    /// Number of distinct keys inserted (keys hitting a false positive on insert are not counted).
+    std::size_t size() const noexcept {
+        return size_;
+    }
+
+    /// Number of keys the filter is sized for.
+    std::size_t capacity() const noexcept {
+        return capacity_;
+    }
+
+    double bitsPerKey() const noexcept {
+        return bitsPerKey_;
+    }
+
+    /// Number of bits set (and tested) per key.
+    unsigned hashCount() const noexcept {
+        return hashCount_;
+    }
+
+    /// Probability that mayContain() returns \c true for a key that has not been inserted.
+    /**
+     * Exact for the current contents and uniformly distributed hashes: the average over blocks
+     * of the probability that all tested bits of the block are set.
+     *
+     * Complexity: O(number of blocks)
+     */
+    double falsePositiveRate() const noexcept {
+        double sum = 0;
+        for (const auto &block : blocks_) {
+            std::size_t setBits = 0;
+            for (auto word : block.words) {
+                setBits += static_cast<std::size_t>(__builtin_popcountll(word));
+            }
+            // the tested bits are distinct
+            double probability = 1;
+            for (unsigned i = 0; i < hashCount_; ++i) {
+                probability *= static_cast<double>(setBits > i ? setBits - i : 0) / static_cast<double>(blockBits - i);
+            }
+            sum += probability;
+        }
+        return sum / static_cast<double>(blocks_.size());
+    }
+
+    /// Bytes of heap memory owned by the filter.
+    std::size_t memoryUsage() const noexcept {
+        return blocks_.capacity() * sizeof(Block);
+    }
+
+private:
+    struct alignas(64) Block {
+        std::array<std::uint64_t, blockBits / 64> words{};
+    };
+
+    std::size_t blockOf(std::uint64_t hash) const noexcept {
+        // Fibonacci hashing; shifting a 64-bit value by 64 is undefined, hence the two steps
+        return static_cast<std::size_t>(((hash * 0x9E3779B97F4A7C15ULL) >> 1) >> (63 - blockCountBits_));
+    }
+
+    /// First tested bit and (odd, so the tested bits are distinct) step between tested bits.
+    static std::pair<std::size_t, std::size_t> bitSequence(std::uint64_t hash) noexcept {
+        const auto mixed = hash * 0xC2B2AE3D27D4EB4FULL;
+        return {static_cast<std::size_t>(mixed >> 55), static_cast<std::size_t>((mixed >> 46) | 1)};
+    }
+
+    double bitsPerKey_;
+    unsigned hashCount_;
+    std::size_t capacity_;
+    unsigned blockCountBits_ = 0;
+    std::size_t size_ = 0;
+    std::vector<Block> blocks_;
+};
+
+} // namespace algos
+
+#endif // ALGORITHMS_BLOCKED_BLOOM_FILTER_HPP_INCLUDED
@@ -0,0 +1,248 @@
+/** \file
+ * \brief ConcurrentAnagramDict implementation.
+ */
+
+#ifndef ALGORITHMS_CONCURRENT_ANAGRAM_DICT_HPP_INCLUDED
+#define ALGORITHMS_CONCURRENT_ANAGRAM_DICT_HPP_INCLUDED
+
+#include "AnagramDict.hpp"
+#include "EpochDomain.hpp"
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional> // std::hash, std::equal_to
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility> // std::move
+#include <vector>
+
+namespace algos {
+
+template <
+    typename KeyCalculator = AnagramSignatureKeyCalculator,
+    typename Hash = std::hash<typename KeyCalculator::key_type>,
+    typename KeyEqual = std::equal_to<typename KeyCalculator::key_type>
+> class BasicConcurrentAnagramDict;
+
+using ConcurrentAnagramDict = BasicConcurrentAnagramDict<>;
+
+/// Anagram dictionary for many concurrent readers and a few writers.
+/**
+ * The dictionary is split into shards by key hash. Every shard is an open-addressing table
+ * of atomic pointers to immutable runs (the key and all its words).
+ *
+ * - findAnagrams() never locks: it enters an EpochDomain::Guard and follows atomic pointers,
+ *   so lookups scale with the number of cores and are never blocked by writers
+ * - insert() locks only its shard's writer mutex, publishes a copy of the run extended by the new word
+ *   (or a grown copy of the table) with a single atomic store and retires the replaced object
+ *   to the EpochDomain, which deletes it when no reader can see it anymore
+ *
+ * Suited for read-mostly workloads: every insert copies the run of its key.
+ */
+template <
+    typename KeyCalculator,
+    typename Hash,
+    typename KeyEqual
+> class BasicConcurrentAnagramDict {
+public:
+    using key_type = typename KeyCalculator::key_type;
+    using mapped_type = typename KeyCalculator::mapped_type;
+    using key_calculator_type = KeyCalculator;
+    using value_type = mapped_type;
+    using size_type = std::size_t;
+
+private:
+    struct Run {
+        key_type key;
+        std::vector<mapped_type> words;
+    };
+
+public:
+    using const_iterator = typename std::vector<mapped_type>::const_iterator;
+
+    /// Result of findAnagrams(): the words sharing the key, kept alive while the view exists.
+    /**
+     * Holds an EpochDomain::Guard, so it must be destroyed by the thread that created it
+     * and should be short-lived (it delays reclamation of replaced runs).
+     */
+    class AnagramsView {
+    public:
+        const_iterator begin() const noexcept {
+            return run_ != nullptr ? run_->words.cbegin() : const_iterator{};
+        }
+
+        const_iterator end() const noexcept {
+            return run_ != nullptr ? run_->words.cend() : const_iterator{};
+        }
+
+        size_type size() const noexcept {
+            return run_ != nullptr ? run_->words.size() : 0;
+        }
+
+        bool empty() const noexcept {
+            return size() == 0;
+        }
+
+    private:
+        friend class BasicConcurrentAnagramDict;
+
+        template <typename FindRun>
+        explicit AnagramsView(FindRun findRun)
+            : run_(findRun()) {} // guard_ is declared first - it is entered before the lookup
+
+        EpochDomain::Guard guard_;
+        const Run *run_;
+    };
+
+public:
+    BasicConcurrentAnagramDict() {
+        for (auto &shard : shards_) {
+            shard.table.store(new Table(minSlotCount), std::memory_order_relaxed);
+        }
+    }
+
+    BasicConcurrentAnagramDict(const BasicConcurrentAnagramDict &) = delete;
+    BasicConcurrentAnagramDict &operator=(const BasicConcurrentAnagramDict &) = delete;
+
+    /// Must not run concurrently with any other member function.
+    ~BasicConcurrentAnagramDict() {
+        for (auto &shard : shards_) {
+            const auto *table = shard.table.load(std::memory_order_relaxed);
+            for (size_type i = 0; i < table->slotCount; ++i) {
+                delete table->slots[i].load(std::memory_order_relaxed);
+            }
+            delete table;
+        }
+    }
+
+    /// Lock-free lookup; safe to call concurrently with insert().
+    AnagramsView findAnagrams(const mapped_type &value) const {
+        const auto key = keyCalculator_.calculateKey(value);
+        const std::uint64_t hash = hash_(key);
+        return AnagramsView{[&]() -> const Run * { // guaranteed copy elision - the guard is not moved
+            const auto *table = shards_[shardOf(hash)].table.load();
+            for (auto index = table->bucketOf(hash); ; index = (index + 1) & table->mask()) {
+                const auto *run = table->slots[index].load();
+                if (run == nullptr || keyEqual_(run->key, key)) {
+                    return run;
+                }
+            }
+        }};
+    }
+
+    /// Insert \p value; safe to call concurrently with findAnagrams() and other inserts.
+    void insert(const mapped_type &value) {
+        auto key = keyCalculator_.calculateKey(value);
+        const std::uint64_t hash = hash_(key);
+        auto &shard = shards_[shardOf(hash)];
+        std::lock_guard<std::mutex> lock{shard.writerMutex};
+
+        auto *table = shard.table.load(std::memory_order_relaxed);
+        auto index = table->bucketOf(hash);
+        for (; ; index = (index + 1) & table->mask()) {
+            const auto *run = table->slots[index].load(std::memory_order_relaxed);
+            if (run == nullptr) {
+                break;
+            }
+            if (keyEqual_(run->key, key)) {
+                auto extended = std::make_unique<Run>(*run);
+                extended->words.push_back(value);
+                table->slots[index].store(extended.release());
+                EpochDomain::instance().retire(run);
+                wordCount_.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+        }
+
+        if ((table->keyCount + 1) * maxLoadDenominator > table->slotCount * maxLoadNumerator) {
+            auto grown = std::make_unique<Table>(table->slotCount * 2);
+            for (size_type i = 0; i < table->slotCount; ++i) {
+                if (const auto *run = table->slots[i].load(std::memory_order_relaxed)) {
+                    grown->insertNew(hash_(run->key), run);
+                }
+            }
+            grown->keyCount = table->keyCount;
+            shard.table.store(grown.get());
+            EpochDomain::instance().retire(table); // runs are now owned by the grown table
+            table = grown.release();
+            index = table->findEmpty(hash);
+        }
+        table->slots[index].store(new Run{std::move(key), {value}});
+        ++table->keyCount;
+        wordCount_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /// Number of words stored (may be momentarily stale while inserts are running).
+    size_type size() const noexcept {
+        return wordCount_.load(std::memory_order_relaxed);
+    }
+
+private:
+    static constexpr unsigned shardBits = 6;
+    static constexpr size_type shardCount = size_type{1} << shardBits;
+    static constexpr size_type minSlotCount = 16;
+    // max load factor 1/2 keeps probe sequences short for the readers
+    static constexpr size_type maxLoadNumerator = 1;
+    static constexpr size_type maxLoadDenominator = 2;
+
+    /// Open-addressing (linear probing) table of run pointers. Deleting it does not delete the runs.
+    struct Table {
+        explicit Table(size_type slotCount)
+            : slotCount(slotCount), slots(new std::atomic<const Run *>[slotCount]) {
+            for (size_type i = 0; i < slotCount; ++i) {
+                slots[i].store(nullptr, std::memory_order_relaxed);
+            }
+            while ((size_type{1} << slotBits) < slotCount) {
+                ++slotBits;
+            }
+        }
+
+        size_type mask() const noexcept {
+            return slotCount - 1;
+        }
+
+        size_type bucketOf(std::uint64_t hash) const noexcept {
+            // the high bits select the shard, so take the bucket from the product's middle bits
+            return static_cast<size_type>(((hash * 0x9E3779B97F4A7C15ULL) >> (64 - shardBits - slotBits)) & mask());
+        }
+
+        size_type findEmpty(std::uint64_t hash) const noexcept {
+            auto index = bucketOf(hash);
+            while (slots[index].load(std::memory_order_relaxed) != nullptr) {
+                index = (index + 1) & mask();
+            }
+            return index;
+        }
+
+        void insertNew(std::uint64_t hash, const Run *run) noexcept {
+            slots[findEmpty(hash)].store(run, std::memory_order_relaxed);
+        }
+
+        size_type slotCount;
+        unsigned slotBits = 0;
+        size_type keyCount = 0; // accessed by the shard's writers only
+        std::unique_ptr<std::atomic<const Run *>[]> slots;
+    };
+
+    struct alignas(64) Shard {
+        std::atomic<Table *> table{nullptr};
+        std::mutex writerMutex;
+    };
+
+    static size_type shardOf(std::uint64_t hash) noexcept {
+        return static_cast<size_type>((hash * 0x9E3779B97F4A7C15ULL) >> (64 - shardBits));
+    }
+
+private:
+    KeyCalculator keyCalculator_;
+    Hash hash_;
+    KeyEqual keyEqual_;
+    std::array<Shard, shardCount> shards_;
+    std::atomic<size_type> wordCount_{0};
+};
+
+} // namespace algos
+
+#endif // ALGORITHMS_CONCURRENT_ANAGRAM_DICT_HPP_INCLUDED
@@ -0,0 +1,205 @@
+/** \file
+ * \brief Epoch-based memory reclamation for lock-free readers.
+ */
+
+#ifndef ALGORITHMS_EPOCH_DOMAIN_HPP_INCLUDED
+#define ALGORITHMS_EPOCH_DOMAIN_HPP_INCLUDED
+
+#include <algorithm> // std::min
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+namespace algos {
+
+/// Epoch-based reclamation (EBR) of objects unlinked from lock-free data structures.
+/**
+ * Readers wrap every access in a Guard, which only stores the current global epoch in the
+ * reader's own cache line - readers never lock and never write shared memory.
+ * Writers unlink an object (atomically replacing the pointer to it), then retire() it;
+ * the object is deleted once every reader that might still see it has left its Guard.
+ *
+ * There is a single process-wide domain (instance()); every thread that ever enters a Guard
+ * occupies one of \ref maxReaders reader slots until it exits.
+ *
+ * Retired objects go to one of \ref retireShards lists picked per thread, each with its own mutex, so writers
+ * on different threads rarely contend. The reader slots are scanned only when a list has grown by
+ * \ref reclaimThreshold objects since its last scan: a retire() costs O(maxReaders / reclaimThreshold) amortized.
+ */
+class EpochDomain {
+public:
+    /// Maximum number of threads using Guards at the same time.
+    static constexpr std::size_t maxReaders = 512;
+    /// Number of retire lists.
+    static constexpr std::size_t retireShards = 16;
+    /// Growth of a retire list that triggers a scan of the reader slots.
+    static constexpr std::size_t reclaimThreshold = 64;
+
+    /// Keeps objects seen by the current thread alive. Guards can be nested; not movable between threads.
+    class Guard {
+    public:
+        Guard() {
+            auto &record = threadRecord();
+            if (record.depth++ == 0) {
+                if (record.slot == nullptr) {
+                    record.slot = instance().claimSlot();
+                }
+                // seq_cst: the announcement must be visible before any pointer of the structure is loaded
+                record.slot->epoch.store(instance().globalEpoch_.load());
+            }
+        }
+
+        Guard(const Guard &) = delete;
+        Guard &operator=(const Guard &) = delete;
+
+        ~Guard() {
+            auto &record = threadRecord();
+            if (--record.depth == 0) {
+                record.slot->epoch.store(inactive, std::memory_order_release);
+            }
+        }
+    };
+
+public:
+    static EpochDomain &instance() {
+        static EpochDomain domain;
+        return domain;
+    }
+
+    EpochDomain(const EpochDomain &) = delete;
+    EpochDomain &operator=(const EpochDomain &) = delete;
+
+    ~EpochDomain() {
+        for (auto &shard : shards_) {
+            for (auto &object : shard.retired) {
+                object.deleter(object.ptr);
+            }
+        }
+    }
+
+    /// Delete \p ptr once no reader can see it. \p ptr must already be unlinked from the structure.
+    template <typename T>
+    void retire(const T *ptr) {
+        retire(const_cast<T *>(ptr), [](void *p) { delete static_cast<T *>(p); });
+    }
+
+    /// Delete \p ptr with \p deleter once no reader can see it.
+    void retire(void *ptr, void (*deleter)(void *)) {
+        auto &record = threadRecord();
+        if (record.shard == nullptr) {
+            record.shard = &shards_[nextShard_.fetch_add(1, std::memory_order_relaxed) % retireShards];
+        }
+        auto &shard = *record.shard;
+        std::lock_guard<std::mutex> lock{shard.mutex};
+        // seq_cst: orders the writer's unlinking store before the scan of reader epochs
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        shard.retired.push_back({ptr, deleter, globalEpoch_.fetch_add(1)});
+        if (shard.retired.size() >= shard.nextReclaim) {
+            reclaim(shard);
+        }
+    }
+
+    /// Delete every retired object no reader can see anymore, whatever the size of the retire lists.
+    void collect() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        for (auto &shard : shards_) {
+            std::lock_guard<std::mutex> lock{shard.mutex};
+            reclaim(shard);
+        }
+    }
+
+    /// Number of retired objects not deleted yet.
+    std::size_t pendingCount() {
+        std::size_t count = 0;
+        for (auto &shard : shards_) {
+            std::lock_guard<std::mutex> lock{shard.mutex};
+            count += shard.retired.size();
+        }
+        return count;
+    }
+
+private:
+    static constexpr std::uint64_t inactive = 0;
+
+    struct alignas(64) ReaderSlot {
+        std::atomic<std::uint64_t> epoch{inactive};
+        std::atomic<bool> owned{false};
+    };
+
+    struct Retired {
+        void *ptr;
+        void (*deleter)(void *);
+        std::uint64_t epoch;
+    };
+
+    struct alignas(64) RetireShard {
+        std::mutex mutex;
+        std::vector<Retired> retired;
+        std::size_t nextReclaim = reclaimThreshold; // size of retired that triggers reclaim()
+    };
+
+    struct ThreadRecord {
+        ReaderSlot *slot = nullptr;
+        RetireShard *shard = nullptr; // the thread's retire list, picked on its first retire()
+        unsigned depth = 0;
+
+        ~ThreadRecord() {
+            if (slot != nullptr) {
+                slot->owned.store(false, std::memory_order_release);
+            }
+        }
+    };
+
+    EpochDomain() = default;
+
+    static ThreadRecord &threadRecord() {
+        thread_local ThreadRecord record;
+        return record;
+    }
+
+    ReaderSlot *claimSlot() {
+        for (auto &slot : readers_) {
+            bool expected = false;
+            if (!slot.owned.load(std::memory_order_relaxed)
+                    && slot.owned.compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+                return &slot;
+            }
+        }
+        throw std::runtime_error{"Too many threads using EpochDomain"};
+    }
+
+    /// Delete retired objects of \p shard older than the oldest epoch announced by an active reader.
+    void reclaim(RetireShard &shard) {
+        auto oldestActive = std::numeric_limits<std::uint64_t>::max();
+        for (const auto &slot : readers_) {
+            const auto epoch = slot.epoch.load();
+            if (epoch != inactive) {
+                oldestActive = std::min(oldestActive, epoch);
+            }
+        }
+        auto kept = shard.retired.begin();
+        for (auto &object : shard.retired) {
+            if (object.epoch < oldestActive) {
+                object.deleter(object.ptr);
+            } else {
+                *kept++ = object;
+            }
+        }
+        shard.retired.erase(kept, shard.retired.end());
+        shard.nextReclaim = shard.retired.size() + reclaimThreshold;
+    }
+
+    std::atomic<std::uint64_t> globalEpoch_{1};
+    std::array<ReaderSlot, maxReaders> readers_;
+    std::array<RetireShard, retireShards> shards_;
+    std::atomic<std::size_t> nextShard_{0};
+};
+
+} // namespace algos
+
+#endif // ALGORITHMS_EPOCH_DOMAIN_HPP_INCLUDED
@@ -0,0 +1,367 @@
+/** \file
+ * \brief FlatAnagramDict implementation.
+ */
+
+#ifndef ALGORITHMS_FLAT_ANAGRAM_DICT_HPP_INCLUDED
+#define ALGORITHMS_FLAT_ANAGRAM_DICT_HPP_INCLUDED
+
+#include "AnagramDict.hpp"
+#include <algorithm> // std::copy_n
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <functional> // std::hash, std::equal_to
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility> // std::pair, std::declval
+#include <vector>
+
+namespace algos {
+
+/// Random access iterator over a run of word references; dereferences to \c std::string_view into the arena.
+/**
+ * Word reference layout: offset in the arena (high 40 bits) and word length (low 24 bits).
+ */
+class WordRunIterator {
+public:
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type = std::string_view;
+    using difference_type = std::ptrdiff_t;
+    using pointer = void;
+    using reference = std::string_view;
+
+    static constexpr unsigned lengthBits = 24;
+    static constexpr std::uint64_t lengthMask = (std::uint64_t{1} << lengthBits) - 1;
+
+public:
+    WordRunIterator() = default;
+
+    WordRunIterator(const std::uint64_t *ref, const char *arena) noexcept
+        : ref_(ref), arena_(arena) {}
+
+    reference operator*() const noexcept {
+        return wordAt(*ref_);
+    }
+    reference operator[](difference_type n) const noexcept {
+        return wordAt(ref_[n]);
+    }
+
+    WordRunIterator &operator++() noexcept { ++ref_; return *this; }
+    WordRunIterator operator++(int) noexcept { auto copy = *this; ++ref_; return copy; }
+    WordRunIterator &operator--() noexcept { --ref_; return *this; }
+    WordRunIterator operator--(int) noexcept { auto copy = *this; --ref_; return copy; }
+    WordRunIterator &operator+=(difference_type n) noexcept { ref_ += n; return *this; }
+    WordRunIterator &operator-=(difference_type n) noexcept { ref_ -= n; return *this; }
+
+    friend WordRunIterator operator+(WordRunIterator it, difference_type n) noexcept { return it += n; }
+    friend WordRunIterator operator+(difference_type n, WordRunIterator it) noexcept { return it += n; }
+    friend WordRunIterator operator-(WordRunIterator it, difference_type n) noexcept { return it -= n; }
+    friend difference_type operator-(const WordRunIterator &lhs, const WordRunIterator &rhs) noexcept {
+        return lhs.ref_ - rhs.ref_;
+    }
+    friend bool operator==(const WordRunIterator &lhs, const WordRunIterator &rhs) noexcept { return lhs.ref_ == rhs.ref_; }
+    friend bool operator!=(const WordRunIterator &lhs, const WordRunIterator &rhs) noexcept { return lhs.ref_ != rhs.ref_; }
+    friend bool operator<(const WordRunIterator &lhs, const WordRunIterator &rhs) noexcept { return lhs.ref_ < rhs.ref_; }
+    friend bool operator>(const WordRunIterator &lhs, const WordRunIterator &rhs) noexcept { return lhs.ref_ > rhs.ref_; }
+    friend bool operator<=(const WordRunIterator &lhs, const WordRunIterator &rhs) noexcept { return lhs.ref_ <= rhs.ref_; }
+    friend bool operator>=(const WordRunIterator &lhs, const WordRunIterator &rhs) noexcept { return lhs.ref_ >= rhs.ref_; }
+
+private:
+    std::string_view wordAt(std::uint64_t ref) const noexcept {
+        return {arena_ + (ref >> lengthBits), static_cast<std::size_t>(ref & lengthMask)};
+    }
+
+    const std::uint64_t *ref_ = nullptr;
+    const char *arena_ = nullptr;
+};
+
+template <
+    typename KeyCalculator = AnagramSignatureKeyCalculator,
+    typename Hash = std::hash<typename KeyCalculator::key_type>,
+    typename KeyEqual = std::equal_to<typename KeyCalculator::key_type>
+> class BasicFlatAnagramDict;
+
+using FlatAnagramDict = BasicFlatAnagramDict<>;
+
+/// Anagram dictionary stored in flat arrays instead of a node-based multimap.
+/**
+ * Storage:
+ * - all words are appended to a single character arena
+ * - every word is referenced by one 64-bit word reference: arena offset (40 bits) and length (24 bits)
+ * - the open-addressing (linear probing) table holds one slot per distinct key; the slot points to
+ *   a contiguous run of word references of all words having this key
+ *
+ * findAnagrams() therefore returns a range over adjacent memory and insert() does not allocate per entry.
+ *
+ * When a run is full it is moved to the end of the references array with doubled capacity,
+ * which leaves a hole behind; the holes are compacted away once they outnumber the live references.
+ *
+ * Complexity (average):
+ * - insert():       amortized O(m)
+ * - findAnagrams(): O(m)
+ *
+ * where:
+ * - m - length of the value
+ *
+ * \note Iterators are invalidated by insert().
+ */
+template <
+    typename KeyCalculator,
+    typename Hash,
+    typename KeyEqual
+> class BasicFlatAnagramDict {
+public:
+    using key_type = typename KeyCalculator::key_type;
+    using mapped_type = typename KeyCalculator::mapped_type;
+    using key_calculator_type = KeyCalculator;
+    using value_type = std::string_view;
+    using size_type = std::size_t;
+
+    using const_iterator = WordRunIterator;
+    using iterator = const_iterator;
+
+public:
+    std::pair<const_iterator, const_iterator> findAnagrams(const mapped_type &value) const {
+        if (slots_.empty()) {
+            return {const_iterator{}, const_iterator{}};
+        }
+        return runOf(slots_[findSlot(keyCalculator_.calculateKey(value))]);
+    }
+
+    /// Look up a batch of values: write \c findAnagrams(*it) for every \c it in [first, last) to \p out.
+    /**
+     * Values are processed in blocks: keys of the whole block are calculated first
+     * (with the SIMD kernels if the key calculator has \c calculateKeys()), then the slots of all the block's
+     * keys are prefetched, and only then probed, so the cache misses of the block overlap.
+     *
+     * \tparam InputIt input iterator whose value is convertible to \c std::string_view
+     * \tparam OutputIt output iterator accepting \c std::pair<const_iterator, const_iterator>
+     * \return \p out past the last written result
+     */
+    template <typename InputIt, typename OutputIt>
+    OutputIt findAnagramsBatch(InputIt first, InputIt last, OutputIt out) const {
+        constexpr std::size_t blockSize = 32;
+        std::string_view values[blockSize];
+        key_type keys[blockSize];
+        size_type slotIndices[blockSize];
+        while (first != last) {
+            std::size_t count = 0;
+            for (; count < blockSize && first != last; ++first) {
+                values[count++] = *first;
+            }
+            if constexpr (detail::has_batch_calculate_keys_v<KeyCalculator>) {
+                keyCalculator_.calculateKeys(values, count, keys);
+            } else {
+                for (std::size_t i = 0; i < count; ++i) {
+                    keys[i] = keyCalculator_.calculateKey(mapped_type(values[i]));
+                }
+            }
+            if (slots_.empty()) {
+                for (std::size_t i = 0; i < count; ++i) {
+                    *out++ = std::pair<const_iterator, const_iterator>{};
+                }
+                continue;
+            }
+            for (std::size_t i = 0; i < count; ++i) {
+                slotIndices[i] = bucketOf(keys[i]);
+                __builtin_prefetch(&slots_[slotIndices[i]]);
+            }
+            for (std::size_t i = 0; i < count; ++i) {
+                slotIndices[i] = findSlotFrom(keys[i], slotIndices[i]);
+                __builtin_prefetch(wordRefs_.data() + slots_[slotIndices[i]].runBegin);
+            }
+            for (std::size_t i = 0; i < count; ++i) {
+                *out++ = runOf(slots_[slotIndices[i]]);
+            }
+        }
+        return out;
+    }
+
+    //TODO std::pair<iterator,bool>
+    /// Insert \p value, return iterator to the inserted word.
+    iterator insert(const mapped_type &value) {
+        auto key = keyCalculator_.calculateKey(value);
+        if ((keyCount_ + 1) * maxLoadDenominator > slots_.size() * maxLoadNumerator) {
+            rehash(slots_.empty() ? minSlotCount : slots_.size() * 2);
+        }
+        auto &slot = slots_[findSlot(key)]; // slots_ is not resized below
+        const auto ref = appendToArena(value);
+        if (slot.runSize == slot.runCapacity) {
+            const bool newKey = slot.runCapacity == 0;
+            growRun(slot);
+            if (newKey) {
+                slot.key = std::move(key);
+                ++keyCount_;
+            }
+        }
+        const auto refIndex = slot.runBegin + slot.runSize++;
+        wordRefs_[refIndex] = ref;
+        ++wordCount_;
+        return const_iterator{wordRefs_.data() + refIndex, arena_.data()};
+    }
+
+    /// Number of words stored.
+    size_type size() const noexcept {
+        return wordCount_;
+    }
+
+    /// Number of distinct keys (anagram classes) stored.
+    size_type keyCount() const noexcept {
+        return keyCount_;
+    }
+
+    /// Call \p fn(key, first, last) for every key, where [first, last) is the run of its words.
+    template <typename Function>
+    void forEachRun(Function fn) const {
+        for (const auto &slot : slots_) {
+            if (slot.runCapacity != 0) {
+                const auto *run = wordRefs_.data() + slot.runBegin;
+                fn(slot.key, const_iterator{run, arena_.data()}, const_iterator{run + slot.runSize, arena_.data()});
+            }
+        }
+    }
+
+    /// Bytes of heap memory owned by the dictionary (allocated capacity, not only the used part).
+    std::size_t memoryUsage() const noexcept {
+        return arena_.capacity() * sizeof(char)
+            + wordRefs_.capacity() * sizeof(std::uint64_t)
+            + slots_.capacity() * sizeof(Slot);
+    }
+
+private:
+    template <typename Dict>
+    friend class FlatAnagramDictBuilder;
+
+    static constexpr unsigned lengthBits = WordRunIterator::lengthBits;
+    static constexpr std::uint64_t lengthMask = WordRunIterator::lengthMask;
+    static constexpr std::uint64_t maxArenaSize = std::uint64_t{1} << (64 - lengthBits);
+    static constexpr size_type minSlotCount = 16;
+    // max load factor 3/4
+    static constexpr size_type maxLoadNumerator = 3;
+    static constexpr size_type maxLoadDenominator = 4;
+
+    struct Slot {
+        key_type key{};
+        std::uint32_t runBegin = 0;
+        std::uint32_t runSize = 0;
+        std::uint32_t runCapacity = 0; // 0 marks an empty slot
+    };
+
+    size_type bucketOf(const key_type &key) const {
+        return bucketOfHash(hash_(key));
+    }
+
+    size_type bucketOfHash(std::uint64_t hash) const noexcept {
+        // Fibonacci hashing: take the high bits so that weak low bits of the hash do not matter
+        return static_cast<size_type>((hash * 0x9E3779B97F4A7C15ULL) >> (64 - slotBits_));
+    }
+
+    std::pair<const_iterator, const_iterator> runOf(const Slot &slot) const noexcept {
+        const auto *run = wordRefs_.data() + slot.runBegin; // empty slot has runSize == 0
+        return {const_iterator{run, arena_.data()}, const_iterator{run + slot.runSize, arena_.data()}};
+    }
+
+    /// Return index of the slot holding \p key or of the empty slot where it would be inserted.
+    size_type findSlot(const key_type &key) const {
+        return findSlotFrom(key, bucketOf(key));
+    }
+
+    /// Like findSlot(), with the bucket of \p key already calculated.
+    size_type findSlotFrom(const key_type &key, size_type index) const {
+        assert(!slots_.empty());
+        const auto mask = slots_.size() - 1;
+        while (slots_[index].runCapacity != 0 && !keyEqual_(slots_[index].key, key)) {
+            index = (index + 1) & mask;
+        }
+        return index;
+    }
+
+    void rehash(size_type slotCount) {
+        assert((slotCount & (slotCount - 1)) == 0);
+        std::vector<Slot> oldSlots(slotCount);
+        oldSlots.swap(slots_);
+        slotBits_ = 0;
+        while ((size_type{1} << slotBits_) < slotCount) {
+            ++slotBits_;
+        }
+        for (auto &slot : oldSlots) {
+            if (slot.runCapacity != 0) {
+                slots_[findSlot(slot.key)] = std::move(slot);
+            }
+        }
+    }
+
+    std::uint64_t appendToArena(const mapped_type &value) {
+        if (value.size() > lengthMask) {
+            throw std::length_error{"Value too long for FlatAnagramDict"};
+        }
+        if (arena_.size() + value.size() > maxArenaSize) {
+            throw std::length_error{"FlatAnagramDict arena size limit exceeded"};
+        }
+        const std::uint64_t offset = arena_.size();
+        arena_.insert(arena_.end(), value.begin(), value.end());
+        return (offset << lengthBits) | value.size();
+    }
+
+    void growRun(Slot &slot) {
+        const std::size_t newCapacity = slot.runCapacity == 0 ? 1 : std::size_t{slot.runCapacity} * 2;
+        if (slot.runCapacity != 0 && slot.runBegin + slot.runCapacity == wordRefs_.size()) {
+            // the run is the last one - extend it in place
+            resizeWordRefs(wordRefs_.size() + (newCapacity - slot.runCapacity));
+            slot.runCapacity = static_cast<std::uint32_t>(newCapacity);
+            return;
+        }
+        if (garbage_ > wordCount_ && garbage_ > minSlotCount) {
+            compact();
+        }
+        const auto newBegin = wordRefs_.size();
+        resizeWordRefs(newBegin + newCapacity);
+        std::copy_n(wordRefs_.begin() + slot.runBegin, slot.runSize, wordRefs_.begin() + newBegin);
+        garbage_ += slot.runCapacity;
+        slot.runBegin = static_cast<std::uint32_t>(newBegin);
+        slot.runCapacity = static_cast<std::uint32_t>(newCapacity);
+    }
+
+    void resizeWordRefs(std::size_t size) {
+        if (size > UINT32_MAX) {
+            throw std::length_error{"FlatAnagramDict word count limit exceeded"};
+        }
+        wordRefs_.resize(size);
+    }
+
+    /// Move all runs next to each other, dropping the holes left by relocated runs.
+    void compact() {
+        std::vector<std::uint64_t> compacted;
+        compacted.reserve(wordRefs_.size() - garbage_);
+        for (auto &slot : slots_) {
+            if (slot.runCapacity != 0) {
+                const auto newBegin = compacted.size();
+                compacted.insert(compacted.end(),
+                    wordRefs_.begin() + slot.runBegin, wordRefs_.begin() + slot.runBegin + slot.runCapacity);
+                slot.runBegin = static_cast<std::uint32_t>(newBegin);
+            }
+        }
+        wordRefs_.swap(compacted);
+        garbage_ = 0;
+    }
+
+private:
+    KeyCalculator keyCalculator_;
+    Hash hash_;
+    KeyEqual keyEqual_;
+
+    std::vector<char> arena_;
+    std::vector<std::uint64_t> wordRefs_;
+    std::vector<Slot> slots_;
+    unsigned slotBits_ = 0;
+    size_type keyCount_ = 0;
+    size_type wordCount_ = 0;
+    size_type garbage_ = 0; // word references left behind by relocated runs
+};
+
+} // namespace algos
+
+#endif // ALGORITHMS_FLAT_ANAGRAM_DICT_HPP_INCLUDED
@@ -0,0 +1,310 @@
+/** \file
+ * \brief Parallel bulk-build of FlatAnagramDict from a word list.
+ */
+
+#ifndef ALGORITHMS_FLAT_ANAGRAM_DICT_BUILDER_HPP_INCLUDED
+#define ALGORITHMS_FLAT_ANAGRAM_DICT_BUILDER_HPP_INCLUDED
+
+#include "../common/MappedFile.hpp"
+#include "../common/ParallelFor.hpp"
+#include "FlatAnagramDict.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring> // std::memchr, std::memcpy
+#include <exception>
+#include <iterator>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <utility> // std::declval
+#include <vector>
+
+namespace algos {
+
+namespace detail {
+
+// primary template handles key calculators without calculateKey(const char *, std::size_t)
+template <typename, typename = std::void_t<> >
+struct has_raw_calculate_key : std::false_type {};
+
+// specialization recognizes key calculators that compute keys without constructing mapped_type
+template <typename T>
+struct has_raw_calculate_key<T,
+        std::void_t<decltype( std::declval<const T &>().calculateKey(std::declval<const char *>(), std::size_t{}) )>
+    > : std::true_type {};
+
+template <typename T>
+inline constexpr bool has_raw_calculate_key_v = has_raw_calculate_key<T>::value;
+
+} // namespace detail
+
+/// Statistics of the last FlatAnagramDictBuilder::build() call.
+struct BulkBuildStats {
+    std::size_t words = 0;
+    std::size_t keys = 0;
+    std::size_t bytes = 0; ///< size of the input word list
+    unsigned threads = 0;
+    double seconds = 0.0;
+
+    double wordsPerSecond() const noexcept {
+        return seconds > 0.0 ? static_cast<double>(words) / seconds : 0.0;
+    }
+};
+
+/// Builds a BasicFlatAnagramDict from a newline-delimited word list in one pass, on all cores.
+/**
+ * Steps:
+ * -# the input is split into line-aligned chunks; every thread calculates keys and key hashes
+ *    of the words of its chunk
+ * -# entries are radix-partitioned by the high bits of the key hash
+ *    (file order is kept within a partition)
+ * -# every partition is stable-sorted by hash and grouped by key
+ * -# the table is allocated once with its final size, so nothing is rehashed, and every thread copies
+ *    the words of its partitions into the arena, anagram runs being adjacent there too
+ *
+ * The resulting dictionary is equal to the one built by calling insert() for every word in file order.
+ * Empty lines are skipped and a trailing \c '\\r' of a line is ignored.
+ *
+ * \tparam Dict a BasicFlatAnagramDict instantiation
+ */
+template <typename Dict = FlatAnagramDict>
+class FlatAnagramDictBuilder {
+public:
+    using key_type = typename Dict::key_type;
+    using mapped_type = typename Dict::mapped_type;
+
+public:
+    /// \param threadCount number of threads to use, 0 means \c std::thread::hardware_concurrency()
+    explicit FlatAnagramDictBuilder(unsigned threadCount = 0)
+        : threadCount_(threadCount != 0 ? threadCount : std::max(1u, std::thread::hardware_concurrency())) {}
+
+    /// Build the dictionary from a memory-mapped word list file (the file is not copied in whole).
+    Dict buildFromFile(const std::string &path) {
+        MappedFile file{path};
+        file.advise(MADV_WILLNEED);
+        return build(file.view());
+    }
+
+    /// Build the dictionary from a word list in memory.
+    Dict build(std::string_view wordList) {
+        const auto startTime = std::chrono::steady_clock::now();
+        if (wordList.size() > Dict::maxArenaSize) {
+            throw std::length_error{"Word list too big for FlatAnagramDict"};
+        }
+
+        Dict dict;
+        const auto chunks = splitIntoChunks(wordList);
+        const std::size_t chunkCount = chunks.size() - 1;
+
+        // 1. keys and hashes of every chunk
+        std::vector<std::vector<Entry> > chunkEntries(chunkCount);
+        std::vector<std::size_t> histogram(chunkCount * partitionCount);
+        detail::parallelFor(chunkCount, threadCount_, [&](std::size_t chunk) {
+            parseChunk(dict, wordList, chunks[chunk], chunks[chunk + 1],
+                chunkEntries[chunk], &histogram[chunk * partitionCount]);
+        });
+
+        // 2. partition by hash, keeping file order within every partition
+        std::vector<Partition> partitions(partitionCount);
+        std::vector<std::size_t> scatterPos(chunkCount * partitionCount);
+        std::size_t entryCount = 0;
+        for (std::size_t part = 0; part < partitionCount; ++part) {
+            partitions[part].begin = entryCount;
+            for (std::size_t chunk = 0; chunk < chunkCount; ++chunk) {
+                scatterPos[chunk * partitionCount + part] = entryCount;
+                entryCount += histogram[chunk * partitionCount + part];
+            }
+            partitions[part].end = entryCount;
+        }
+        if (entryCount > UINT32_MAX) {
+            throw std::length_error{"FlatAnagramDict word count limit exceeded"};
+        }
+        std::vector<Entry> entries(entryCount);
+        detail::parallelFor(chunkCount, threadCount_, [&](std::size_t chunk) {
+            auto *pos = &scatterPos[chunk * partitionCount];
+            for (const auto &entry : chunkEntries[chunk]) {
+                entries[pos[partitionOf(entry.hash)]++] = entry;
+            }
+            std::vector<Entry>{}.swap(chunkEntries[chunk]);
+        });
+
+        // 3. group every partition by key
+        detail::parallelFor(partitionCount, threadCount_, [&](std::size_t part) {
+            groupPartition(dict, wordList, entries, partitions[part]);
+        });
+
+        // 4. allocate the final storage once and fill it
+        std::size_t charCount = 0, keyCount = 0;
+        for (auto &partition : partitions) {
+            partition.charBegin = charCount;
+            charCount += partition.charCount;
+            keyCount += partition.runs.size();
+        }
+        std::size_t slotCount = Dict::minSlotCount;
+        while (keyCount * Dict::maxLoadDenominator > slotCount * Dict::maxLoadNumerator) {
+            slotCount *= 2;
+        }
+        dict.rehash(slotCount);
+        dict.arena_.resize(charCount);
+        dict.wordRefs_.resize(entryCount);
+        const auto mask = slotCount - 1;
+        for (auto &partition : partitions) {
+            for (auto &run : partition.runs) {
+                auto index = dict.bucketOfHash(run.hash);
+                while (dict.slots_[index].runCapacity != 0) {
+                    index = (index + 1) & mask;
+                }
+                auto &slot = dict.slots_[index];
+                slot.key = std::move(run.key);
+                slot.runBegin = static_cast<std::uint32_t>(run.begin);
+                slot.runSize = slot.runCapacity = static_cast<std::uint32_t>(run.size);
+            }
+            std::vector<Run>{}.swap(partition.runs);
+        }
+        detail::parallelFor(partitionCount, threadCount_, [&](std::size_t part) {
+            const auto &partition = partitions[part];
+            auto charPos = partition.charBegin;
+            for (auto i = partition.begin; i < partition.end; ++i) {
+                const auto length = entries[i].ref & Dict::lengthMask;
+                std::memcpy(dict.arena_.data() + charPos, wordList.data() + (entries[i].ref >> Dict::lengthBits), length);
+                dict.wordRefs_[i] = (std::uint64_t{charPos} << Dict::lengthBits) | length;
+                charPos += length;
+            }
+        });
+        dict.keyCount_ = keyCount;
+        dict.wordCount_ = entryCount;
+
+        stats_.words = entryCount;
+        stats_.keys = keyCount;
+        stats_.bytes = wordList.size();
+        stats_.threads = threadCount_;
+        stats_.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+        return dict;
+    }
+
+    /// Statistics of the last build (words, keys, input bytes, time, throughput).
+    const BulkBuildStats &stats() const noexcept {
+        return stats_;
+    }
+
+private:
+    static constexpr unsigned partitionBits = 8;
+    static constexpr std::size_t partitionCount = std::size_t{1} << partitionBits;
+    static constexpr std::size_t minChunkSize = std::size_t{1} << 16;
+
+    struct Entry {
+        std::uint64_t hash;
+        std::uint64_t ref; // offset in the input << lengthBits | length
+    };
+
+    struct Run {
+        key_type key;
+        std::uint64_t hash;
+        std::size_t begin; // index of the first entry
+        std::size_t size;
+    };
+
+    struct Partition {
+        std::size_t begin = 0; // entries [begin, end)
+        std::size_t end = 0;
+        std::size_t charCount = 0;
+        std::size_t charBegin = 0; // offset in the arena
+        std::vector<Run> runs;
+    };
+
+    static std::size_t partitionOf(std::uint64_t hash) noexcept {
+        // different multiplier than Dict::bucketOfHash() so that partitions do not correlate with buckets
+        return static_cast<std::size_t>((hash * 0xC2B2AE3D27D4EB4FULL) >> (64 - partitionBits));
+    }
+
+    /// Return line-aligned chunk boundaries: chunk \c i is [result[i], result[i + 1]).
+    std::vector<std::size_t> splitIntoChunks(std::string_view wordList) const {
+        const std::size_t chunkCount = std::max<std::size_t>(1,
+            std::min<std::size_t>(threadCount_, wordList.size() / minChunkSize));
+        std::vector<std::size_t> bounds{0};
+        for (std::size_t chunk = 1; chunk < chunkCount; ++chunk) {
+            const auto pos = std::max(wordList.size() / chunkCount * chunk, bounds.back());
+            const auto newline = wordList.find('\n', pos);
+            bounds.push_back(newline == std::string_view::npos ? wordList.size() : newline + 1);
+        }
+        bounds.push_back(wordList.size());
+        return bounds;
+    }
+
+    static key_type keyOf(const Dict &dict, const char *word, std::size_t length) {
+        if constexpr (detail::has_raw_calculate_key_v<decltype(dict.keyCalculator_)>) {
+            return dict.keyCalculator_.calculateKey(word, length);
+        } else {
+            return dict.keyCalculator_.calculateKey(mapped_type(word, length));
+        }
+    }
+
+    static key_type keyOf(const Dict &dict, std::string_view wordList, const Entry &entry) {
+        return keyOf(dict, wordList.data() + (entry.ref >> Dict::lengthBits),
+            static_cast<std::size_t>(entry.ref & Dict::lengthMask));
+    }
+
+    static void parseChunk(const Dict &dict, std::string_view wordList, std::size_t begin, std::size_t end,
+            std::vector<Entry> &entries, std::size_t *histogram) {
+        const char *data = wordList.data();
+        for (auto pos = begin; pos < end;) {
+            const auto *newline = static_cast<const char *>(std::memchr(data + pos, '\n', end - pos));
+            const std::size_t lineEnd = newline != nullptr ? static_cast<std::size_t>(newline - data) : end;
+            auto length = lineEnd - pos;
+            if (length != 0 && data[lineEnd - 1] == '\r') {
+                --length;
+            }
+            if (length > Dict::lengthMask) {
+                throw std::length_error{"Value too long for FlatAnagramDict"};
+            }
+            if (length != 0) {
+                const std::uint64_t hash = dict.hash_(keyOf(dict, data + pos, length));
+                entries.push_back({hash, (std::uint64_t{pos} << Dict::lengthBits) | length});
+                ++histogram[partitionOf(hash)];
+            }
+            pos = lineEnd + 1;
+        }
+    }
+
+    static void groupPartition(const Dict &dict, std::string_view wordList, std::vector<Entry> &entries,
+            Partition &partition) {
+        const auto first = entries.begin() + partition.begin;
+        const auto last = entries.begin() + partition.end;
+        std::stable_sort(first, last, [](const Entry &lhs, const Entry &rhs) {
+            return lhs.hash < rhs.hash;
+        });
+        for (auto groupBegin = first; groupBegin != last;) {
+            const auto hash = groupBegin->hash;
+            const auto groupEnd = std::find_if(groupBegin, last, [hash](const Entry &entry) {
+                return entry.hash != hash;
+            });
+            // equal hashes of different keys are rare - split them keeping the order within every key
+            while (groupBegin != groupEnd) {
+                auto key = keyOf(dict, wordList, *groupBegin);
+                const auto keyEnd = std::stable_partition(std::next(groupBegin), groupEnd, [&](const Entry &entry) {
+                    return dict.keyEqual_(keyOf(dict, wordList, entry), key);
+                });
+                for (auto it = groupBegin; it != keyEnd; ++it) {
+                    partition.charCount += static_cast<std::size_t>(it->ref & Dict::lengthMask);
+                }
+                partition.runs.push_back({std::move(key), hash,
+                    static_cast<std::size_t>(groupBegin - entries.begin()), static_cast<std::size_t>(keyEnd - groupBegin)});
+                groupBegin = keyEnd;
+            }
+        }
+    }
+
+private:
+    unsigned threadCount_;
+    BulkBuildStats stats_;
+};
+
+} // namespace algos
+
+#endif // ALGORITHMS_FLAT_ANAGRAM_DICT_BUILDER_HPP_INCLUDED
@@ -0,0 +1,136 @@
+/** \file
+ * \brief Vectorized kernels packing letter counts of short words into nibbles.
+ */
+
+#ifndef ALGORITHMS_LETTER_COUNT_KERNELS_HPP_INCLUDED
+#define ALGORITHMS_LETTER_COUNT_KERNELS_HPP_INCLUDED
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring> // std::memcpy
+
+#if defined(__x86_64__) || defined(__i386__)
+#define ALGORITHMS_LETTER_COUNT_KERNELS_X86 1
+#include <immintrin.h>
+#endif
+
+namespace algos {
+
+namespace detail {
+
+/// Words of at most this many characters cannot have a letter count overflowing its nibble.
+inline constexpr std::size_t maxShortWordSize = 15;
+
+/// Kernel packing the 4-bit letter counts of a short word (see LetterCountSignature).
+/**
+ * Letters are case-insensitive. Requires \p size <= \ref maxShortWordSize.
+ *
+ * \return \c false if the word contains a character that is not a letter (\p low and \p high are then unspecified)
+ */
+using PackShortWordFn = bool (*)(const char *data, std::size_t size, std::uint64_t &low, std::uint64_t &high);
+
+inline bool packShortWordScalar(const char *data, std::size_t size, std::uint64_t &low, std::uint64_t &high) {
+    std::uint64_t words[2] = {0, 0};
+    for (std::size_t i = 0; i < size; ++i) {
+        // folding bit 5 maps exactly 'A'..'Z' and 'a'..'z' to 'a'..'z'
+        const unsigned index = static_cast<unsigned char>(data[i] | 0x20) - static_cast<unsigned>('a');
+        if (index >= 26) {
+            return false;
+        }
+        words[index >> 4] += std::uint64_t{1} << ((index & 15) * 4);
+    }
+    low = words[0];
+    high = words[1];
+    return true;
+}
+
+#ifdef ALGORITHMS_LETTER_COUNT_KERNELS_X86
+
+/// Load \p size (<= 16) bytes into a vector, convert them to letter indices and validate them.
+/**
+ * Positions past \p size get index 0xFF.
+ * \return \c false if some of the first \p size bytes is not a letter
+ */
+__attribute__((target("sse2")))
+inline bool loadLetterIndices(const char *data, std::size_t size, __m128i &indices) {
+    alignas(16) char buffer[16] = {};
+    std::memcpy(buffer, data, size);
+    const __m128i chars = _mm_load_si128(reinterpret_cast<const __m128i *>(buffer));
+    const __m128i index = _mm_sub_epi8(_mm_or_si128(chars, _mm_set1_epi8(0x20)), _mm_set1_epi8('a'));
+    const __m128i isLetter = _mm_cmpeq_epi8(_mm_min_epu8(index, _mm_set1_epi8(25)), index);
+    const __m128i position = _mm_setr_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+    const __m128i inWord = _mm_cmplt_epi8(position, _mm_set1_epi8(static_cast<char>(size)));
+    if (_mm_movemask_epi8(_mm_andnot_si128(isLetter, inWord)) != 0) {
+        return false;
+    }
+    indices = _mm_or_si128(index, _mm_andnot_si128(inWord, _mm_set1_epi8(-1)));
+    return true;
+}
+
+/// SSE2: vectorized case folding and validation, branch-free scalar accumulation.
+__attribute__((target("sse2")))
+inline bool packShortWordSse2(const char *data, std::size_t size, std::uint64_t &low, std::uint64_t &high) {
+    __m128i indices;
+    if (!loadLetterIndices(data, size, indices)) {
+        return false;
+    }
+    alignas(16) std::uint8_t index[16];
+    _mm_store_si128(reinterpret_cast<__m128i *>(index), indices);
+    std::uint64_t words[2] = {0, 0};
+    for (std::size_t i = 0; i < size; ++i) {
+        words[index[i] >> 4] += std::uint64_t{1} << ((index[i] & 15) * 4);
+    }
+    low = words[0];
+    high = words[1];
+    return true;
+}
+
+/// AVX2: 4 letters per step with variable 64-bit shifts; shifts of 64 and more produce 0.
+__attribute__((target("avx2")))
+inline bool packShortWordAvx2(const char *data, std::size_t size, std::uint64_t &low, std::uint64_t &high) {
+    __m128i indices;
+    if (!loadLetterIndices(data, size, indices)) {
+        return false;
+    }
+    const __m256i one = _mm256_set1_epi64x(1);
+    const __m256i sixteen = _mm256_set1_epi64x(16);
+    __m256i lowSum = _mm256_setzero_si256(), highSum = _mm256_setzero_si256();
+    for (std::size_t i = 0; i < size; i += 4) {
+        const __m256i index = _mm256_cvtepu8_epi64(indices);
+        // index < 16 contributes to low only; 16..25 to high only (negative shift is huge unsigned);
+        // padding index 0xFF shifts out of both
+        lowSum = _mm256_add_epi64(lowSum, _mm256_sllv_epi64(one, _mm256_slli_epi64(index, 2)));
+        highSum = _mm256_add_epi64(highSum, _mm256_sllv_epi64(one, _mm256_slli_epi64(_mm256_sub_epi64(index, sixteen), 2)));
+        indices = _mm_srli_si128(indices, 4);
+    }
+    alignas(32) std::uint64_t lows[4], highs[4];
+    _mm256_store_si256(reinterpret_cast<__m256i *>(lows), lowSum);
+    _mm256_store_si256(reinterpret_cast<__m256i *>(highs), highSum);
+    low = lows[0] + lows[1] + lows[2] + lows[3];
+    high = highs[0] + highs[1] + highs[2] + highs[3];
+    return true;
+}
+
+#endif // ALGORITHMS_LETTER_COUNT_KERNELS_X86
+
+/// Select the fastest kernel supported by the CPU the program runs on.
+inline PackShortWordFn selectPackShortWord() {
+#ifdef ALGORITHMS_LETTER_COUNT_KERNELS_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return packShortWordAvx2;
+    }
+    return packShortWordSse2;
+#else
+    return packShortWordScalar;
+#endif
+}
+
+/// Kernel chosen at program start-up by selectPackShortWord().
+inline const PackShortWordFn packShortWord = selectPackShortWord();
+
+} // namespace detail
+
+} // namespace algos
+
+#endif // ALGORITHMS_LETTER_COUNT_KERNELS_HPP_INCLUDED
@@ -0,0 +1,236 @@
+/** \file
+ * \brief SubAnagramIndex implementation.
+ */
+
+#ifndef ALGORITHMS_SUB_ANAGRAM_INDEX_HPP_INCLUDED
+#define ALGORITHMS_SUB_ANAGRAM_INDEX_HPP_INCLUDED
+
+#include "AnagramDict.hpp"
+#include <algorithm> // std::sort
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <utility> // std::pair
+#include <vector>
+
+namespace algos {
+
+/// Index answering sub-anagram queries: all words that can be built from the given letters.
+/**
+ * A word matches if every letter occurs in it at most as many times as in the query.
+ *
+ * The index is a trie over the letter counts of the dictionary's anagram classes: level \c i
+ * branches on the count of the \c i-th letter and children are sorted by count. A query walks only
+ * the children whose count does not exceed the query's count of that letter, so whole subtrees of
+ * words needing unavailable letters are skipped. Levels are ordered from the least to the most
+ * frequent English letter, which prunes most words close to the root.
+ *
+ * A subtree holding a single anagram class is cut off as a leaf storing the class;
+ * the remaining levels are then checked against the class's letter counts at once.
+ * This keeps the trie at a few nodes per class.
+ *
+ * Complexity of findSubAnagrams():
+ * - Time: O(m + v + r)
+ *
+ * where:
+ * - m - length of the query
+ * - v - number of visited trie nodes; a node is visited only if all the letter counts on its path are
+ *   available, so v depends on the matching anagram classes (and near misses), not on the dictionary size
+ * - r - number of words found
+ *
+ * \note The index refers to the words stored in the dictionary it was built from:
+ *   the dictionary must outlive the index and must not be modified.
+ */
+class SubAnagramIndex {
+public:
+    using size_type = std::size_t;
+
+private:
+    using Counts = std::array<std::uint32_t, detail::alphabetSize>;
+    /// Letter counts saturated at 255 (\ref saturated), indexed by trie level.
+    using SmallCounts = std::array<std::uint8_t, detail::alphabetSize>;
+
+public:
+    /// Build the index of all words of \p dict (any dictionary providing forEachRun()).
+    template <typename Dict>
+    explicit SubAnagramIndex(const Dict &dict) {
+        struct Class {
+            Counts counts;
+            std::vector<std::string_view>::size_type firstWord;
+            std::vector<std::string_view>::size_type wordCount;
+        };
+        std::vector<std::string_view> words;
+        std::vector<Class> classes;
+        dict.forEachRun([&](const auto &, auto first, auto last) {
+            Class anagramClass{countLetters(detail::wordOf(*first)), words.size(), 0};
+            for (; first != last; ++first) {
+                words.push_back(detail::wordOf(*first));
+            }
+            anagramClass.wordCount = words.size() - anagramClass.firstWord;
+            classes.push_back(anagramClass);
+        });
+        if (classes.empty()) {
+            return;
+        }
+        std::sort(classes.begin(), classes.end(), [](const Class &lhs, const Class &rhs) {
+            return lhs.counts < rhs.counts;
+        });
+        // words and counts in the sorted order of classes, so every node covers contiguous ranges
+        std::vector<std::uint32_t> classFirstWord;
+        words_.reserve(words.size());
+        classCounts_.reserve(classes.size());
+        for (const auto &anagramClass : classes) {
+            classFirstWord.push_back(static_cast<std::uint32_t>(words_.size()));
+            words_.insert(words_.end(), words.begin() + anagramClass.firstWord,
+                words.begin() + anagramClass.firstWord + anagramClass.wordCount);
+            SmallCounts counts;
+            for (std::size_t level = 0; level < detail::alphabetSize; ++level) {
+                counts[level] = static_cast<std::uint8_t>(std::min<std::uint32_t>(anagramClass.counts[level], saturated));
+            }
+            classCounts_.push_back(counts);
+        }
+        classFirstWord.push_back(static_cast<std::uint32_t>(words_.size()));
+
+        // breadth-first construction: the children of every node are contiguous
+        struct Range {
+            std::size_t first; // classes [first, last)
+            std::size_t last;
+        };
+        std::vector<Range> ranges{{0, classes.size()}};
+        nodes_.push_back({0, 0, 0, internalNode});
+        std::size_t levelBegin = 0;
+        for (std::size_t level = 0; level <= detail::alphabetSize; ++level) {
+            const auto levelEnd = nodes_.size();
+            for (auto node = levelBegin; node < levelEnd; ++node) {
+                const auto [first, last] = ranges[node];
+                if (level == detail::alphabetSize || last - first == 1) {
+                    // leaf: refers to the words of its classes instead of child nodes
+                    nodes_[node].first = classFirstWord[first];
+                    nodes_[node].size = classFirstWord[last] - classFirstWord[first];
+                    // classes of a full-depth leaf have all counts checked by the path
+                    nodes_[node].leafClass = level == detail::alphabetSize ? fullDepthLeaf : static_cast<std::uint32_t>(first);
+                    continue;
+                }
+                nodes_[node].first = static_cast<std::uint32_t>(nodes_.size());
+                for (auto begin = first; begin < last;) {
+                    auto end = begin;
+                    while (end < last && classes[end].counts[level] == classes[begin].counts[level]) {
+                        ++end;
+                    }
+                    nodes_.push_back({classes[begin].counts[level], 0, 0, internalNode});
+                    ranges.push_back({begin, end});
+                    begin = end;
+                }
+                nodes_[node].size = static_cast<std::uint32_t>(nodes_.size() - nodes_[node].first);
+            }
+            levelBegin = levelEnd;
+        }
+    }
+
+    /// Write every word buildable from \p letters (as \c std::string_view) to \p out.
+    /**
+     * Throws \c std::invalid_argument if \p letters contains a character that is not a letter.
+     * \return \p out past the last written word
+     */
+    template <typename OutputIt>
+    OutputIt findSubAnagrams(std::string_view letters, OutputIt out) const {
+        const auto available = countLetters(letters);
+        if (nodes_.empty()) {
+            return out;
+        }
+        struct Frame {
+            std::uint32_t node;
+            std::uint32_t level;
+        };
+        std::vector<Frame> stack{{0, 0}};
+        while (!stack.empty()) {
+            const auto [nodeIndex, level] = stack.back();
+            stack.pop_back();
+            const auto &node = nodes_[nodeIndex];
+            if (node.leafClass != internalNode) {
+                if (node.leafClass == fullDepthLeaf || fits(node, available)) {
+                    for (auto i = node.first; i < node.first + node.size; ++i) {
+                        *out++ = words_[i];
+                    }
+                }
+                continue;
+            }
+            // children are sorted by count: stop at the first one needing more letters than available
+            for (auto child = node.first;
+                    child < node.first + node.size && nodes_[child].count <= available[level]; ++child) {
+                stack.push_back({child, level + 1});
+            }
+        }
+        return out;
+    }
+
+    /// Number of words indexed.
+    size_type size() const noexcept {
+        return words_.size();
+    }
+
+    /// Bytes of heap memory owned by the index.
+    std::size_t memoryUsage() const noexcept {
+        return nodes_.capacity() * sizeof(Node) + words_.capacity() * sizeof(std::string_view)
+            + classCounts_.capacity() * sizeof(SmallCounts);
+    }
+
+private:
+    static constexpr std::uint32_t internalNode = UINT32_MAX;
+    static constexpr std::uint32_t fullDepthLeaf = UINT32_MAX - 1;
+    static constexpr std::uint8_t saturated = UINT8_MAX;
+
+    struct Node {
+        std::uint32_t count; // count of the parent level's letter
+        std::uint32_t first; // first child node, or first word of a leaf
+        std::uint32_t size; // number of child nodes, or of words of a leaf
+        std::uint32_t leafClass; // class to check at a leaf, fullDepthLeaf or internalNode
+    };
+
+    /// Check whether every letter count of the class of \p leaf does not exceed the \p available count.
+    bool fits(const Node &leaf, const Counts &available) const {
+        const auto &counts = classCounts_[leaf.leafClass];
+        bool fit = true;
+        bool saturatedCount = false;
+        for (std::size_t level = 0; level < detail::alphabetSize; ++level) {
+            fit &= counts[level] <= available[level];
+            saturatedCount |= counts[level] == saturated;
+        }
+        if (fit && saturatedCount) { // some letter occurs 255+ times - count the letters exactly
+            const auto exact = countLetters(words_[leaf.first]);
+            for (std::size_t level = 0; level < detail::alphabetSize; ++level) {
+                fit &= exact[level] <= available[level];
+            }
+        }
+        return fit;
+    }
+
+    /// Trie level of every letter index: from the least to the most frequent letter in English.
+    static constexpr std::array<std::uint8_t, detail::alphabetSize> levelOfLetter() {
+        constexpr char byFrequency[] = "ZJQXKVBPGWYFMCULDHRSNIOATE";
+        std::array<std::uint8_t, detail::alphabetSize> levels{};
+        for (std::size_t level = 0; level < detail::alphabetSize; ++level) {
+            levels[static_cast<std::size_t>(byFrequency[level] - 'A')] = static_cast<std::uint8_t>(level);
+        }
+        return levels;
+    }
+
+    /// Letter counts of \p word, indexed by trie level.
+    static Counts countLetters(std::string_view word) {
+        static constexpr auto levels = levelOfLetter();
+        Counts counts{};
+        for (auto c : word) {
+            ++counts[levels[detail::letterIndexOf(c)]];
+        }
+        return counts;
+    }
+
+    std::vector<Node> nodes_;
+    std::vector<std::string_view> words_;
+    std::vector<SmallCounts> classCounts_;
+};
+
+} // namespace algos
+
+#endif // ALGORITHMS_SUB_ANAGRAM_INDEX_HPP_INCLUDED
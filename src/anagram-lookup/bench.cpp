@@ -0,0 +1,325 @@
+#include "AnagramDict.hpp"
+#include "AnagramScanner.hpp"
+#include "ConcurrentAnagramDict.hpp"
+#include "FlatAnagramDict.hpp"
+#include "SubAnagramIndex.hpp"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iterator>
+#include <mutex>
+#include <random>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Benchmarks of anagram dictionaries:
+// - batched vs per-call lookups in FlatAnagramDict
+// - lookups of missing keys in AnagramDict with and without a key filter
+// - scanning text for anagram occurrences: AnagramScanner vs findAnagrams on every substring
+// - sub-anagram queries: SubAnagramIndex vs a linear scan
+// - multi-threaded throughput of concurrent lookups and inserts
+// usage: ./anagramDictBench [milliseconds-per-run]
+
+namespace {
+
+std::vector<std::string> makeWords(std::size_t count, std::uint64_t seed) {
+    std::mt19937_64 random{seed};
+    std::vector<std::string> words(count);
+    for (auto &word : words) {
+        word.resize(3 + random() % 8);
+        for (auto &letter : word) {
+            letter = static_cast<char>('a' + random() % 26);
+        }
+    }
+    return words;
+}
+
+/// Baseline: node-based dictionary guarded by a readers-writer lock.
+class SharedMutexAnagramDict {
+public:
+    std::size_t findAnagrams(const std::string &value) const {
+        std::shared_lock<std::shared_mutex> lock{mutex_};
+        auto [first, last] = dict_.findAnagrams(value);
+        return static_cast<std::size_t>(std::distance(first, last));
+    }
+
+    void insert(const std::string &value) {
+        std::unique_lock<std::shared_mutex> lock{mutex_};
+        dict_.insert(value);
+    }
+
+private:
+    mutable std::shared_mutex mutex_;
+    algos::AnagramDict dict_;
+};
+
+std::size_t countAnagrams(const algos::ConcurrentAnagramDict &dict, const std::string &value) {
+    return dict.findAnagrams(value).size();
+}
+
+std::size_t countAnagrams(const SharedMutexAnagramDict &dict, const std::string &value) {
+    return dict.findAnagrams(value);
+}
+
+/// Return operations per second of \p threadCount threads doing \p readPercent % lookups, the rest inserts.
+template <typename Dict>
+double measure(Dict &dict, const std::vector<std::string> &queries, const std::vector<std::string> &newWords,
+        unsigned threadCount, unsigned readPercent, std::chrono::milliseconds duration) {
+    std::atomic<bool> start{false}, stop{false};
+    std::atomic<std::size_t> totalOps{0}, checksum{0};
+    std::vector<std::thread> threads;
+    for (unsigned t = 0; t < threadCount; ++t) {
+        threads.emplace_back([&, t] {
+            std::mt19937_64 random{t + 1};
+            std::size_t ops = 0, found = 0;
+            while (!start.load()) {
+                std::this_thread::yield();
+            }
+            while (!stop.load(std::memory_order_relaxed)) {
+                for (int i = 0; i < 64; ++i, ++ops) {
+                    if (random() % 100 < readPercent) {
+                        found += countAnagrams(dict, queries[random() % queries.size()]);
+                    } else {
+                        dict.insert(newWords[random() % newWords.size()]);
+                    }
+                }
+            }
+            totalOps += ops;
+            checksum += found;
+        });
+    }
+    const auto begin = std::chrono::steady_clock::now();
+    start = true;
+    std::this_thread::sleep_for(duration);
+    stop = true;
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - begin;
+    return static_cast<double>(totalOps.load()) / elapsed.count();
+}
+
+void benchmarkBatchLookup() {
+    algos::FlatAnagramDict dict;
+    for (const auto &word : makeWords(2000000, 4)) { // much bigger than the caches
+        dict.insert(word);
+    }
+    const auto words = makeWords(1000000, 5);
+    const std::vector<std::string_view> queries(words.begin(), words.end());
+    std::vector<std::pair<algos::FlatAnagramDict::const_iterator, algos::FlatAnagramDict::const_iterator> >
+        results(queries.size());
+
+    const auto timeQueries = [&](auto lookup) {
+        const auto begin = std::chrono::steady_clock::now();
+        lookup();
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - begin;
+        std::size_t found = 0;
+        for (const auto &[first, last] : results) {
+            found += static_cast<std::size_t>(last - first);
+        }
+        return std::make_pair(static_cast<double>(queries.size()) / elapsed.count(), found);
+    };
+    const auto [perCallRate, perCallFound] = timeQueries([&] {
+        std::string query;
+        for (std::size_t i = 0; i < queries.size(); ++i) {
+            query.assign(queries[i]);
+            results[i] = dict.findAnagrams(query);
+        }
+    });
+    const auto [batchRate, batchFound] = timeQueries([&] {
+        dict.findAnagramsBatch(queries.begin(), queries.end(), results.begin());
+    });
+    std::printf("FlatAnagramDict lookups (%zu words, %zu queries, %zu / %zu found)\n",
+        dict.size(), queries.size(), perCallFound, batchFound);
+    std::printf("  %-20s %10.3f Mqueries/s\n", "findAnagrams", perCallRate / 1e6);
+    std::printf("  %-20s %10.3f Mqueries/s\n\n", "findAnagramsBatch", batchRate / 1e6);
+}
+
+void benchmarkKeyFilter() {
+    // long words make missing keys the common case
+    std::vector<std::string> words(1000000), queries(1000000);
+    std::mt19937_64 random{8};
+    for (auto *list : {&words, &queries}) {
+        for (auto &word : *list) {
+            word.resize(8 + random() % 8);
+            for (auto &letter : word) {
+                letter = static_cast<char>('a' + random() % 26);
+            }
+        }
+    }
+    const auto timeQueries = [&](const auto &dict) {
+        std::size_t found = 0;
+        const auto begin = std::chrono::steady_clock::now();
+        for (const auto &query : queries) {
+            auto [first, last] = dict.findAnagrams(query);
+            found += first != last;
+        }
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - begin;
+        return std::make_pair(static_cast<double>(queries.size()) / elapsed.count(), found);
+    };
+
+    algos::AnagramDict dict;
+    for (const auto &word : words) {
+        dict.insert(word);
+    }
+    const auto [rate, found] = timeQueries(dict);
+    std::printf("AnagramDict lookups of mostly missing keys (%zu words, %zu queries, %zu found)\n",
+        dict.size(), queries.size(), found);
+    std::printf("  %-14s %10s %12s %10s %12s\n", "filter", "Mq/s", "filter MB", "FP rate", "measured FP");
+    std::printf("  %-14s %10.3f %12s %10s %12s\n", "none", rate / 1e6, "-", "-", "-");
+    for (double bitsPerKey : {4.0, 8.0, 12.0, 16.0}) {
+        algos::FilteredAnagramDict filteredDict{algos::BlockedBloomFilter{bitsPerKey, words.size()}};
+        for (const auto &word : words) {
+            filteredDict.insert(word);
+        }
+        const auto [filteredRate, filteredFound] = timeQueries(filteredDict);
+        std::size_t passed = 0;
+        for (const auto &query : queries) {
+            passed += filteredDict.keyFilter().mayContain(std::hash<algos::LetterCountSignature>{}(
+                algos::AnagramSignatureKeyCalculator{}.calculateKey(query)));
+        }
+        char name[32];
+        std::snprintf(name, sizeof name, "bloom %g b/key", bitsPerKey);
+        std::printf("  %-14s %10.3f %12.1f %10.4f %12.4f\n", name, filteredRate / 1e6,
+            static_cast<double>(filteredDict.keyFilter().memoryUsage()) / 1e6, filteredDict.keyFilter().falsePositiveRate(),
+            static_cast<double>(passed - filteredFound) / static_cast<double>(queries.size() - filteredFound));
+    }
+    std::printf("\n");
+}
+
+void benchmarkScanner() {
+    const std::size_t minLength = 6, maxLength = 10; // shorter words of makeWords() would match almost everywhere
+    algos::FlatAnagramDict dict;
+    for (const auto &word : makeWords(200000, 9)) {
+        if (word.size() >= minLength) {
+            dict.insert(word);
+        }
+    }
+    std::string text(16 << 20, ' ');
+    std::mt19937_64 random{10};
+    for (auto &c : text) {
+        c = random() % 8 == 0 ? ' ' : static_cast<char>('a' + random() % 26);
+    }
+
+    algos::AnagramScanner scanner{dict};
+    std::size_t scannerFound = 0;
+    auto begin = std::chrono::steady_clock::now();
+    scanner.scan(text.begin(), text.end(), [&](const algos::AnagramOccurrence &) { ++scannerFound; });
+    const std::chrono::duration<double> scannerElapsed = std::chrono::steady_clock::now() - begin;
+
+    // every substring of a prefix only - the baseline is too slow for the whole text
+    const std::size_t prefixSize = 1 << 20;
+    std::size_t naiveFound = 0, prefixFound = 0;
+    scanner.reset();
+    scanner.scan(text.begin(), text.begin() + prefixSize, [&](const algos::AnagramOccurrence &) { ++prefixFound; });
+    std::string window;
+    begin = std::chrono::steady_clock::now();
+    for (std::size_t offset = 0; offset < prefixSize; ++offset) {
+        for (std::size_t length = minLength; length <= maxLength && offset + length <= prefixSize; ++length) {
+            window.assign(text, offset, length);
+            if (window.find(' ') == std::string::npos) {
+                auto [first, last] = dict.findAnagrams(window);
+                naiveFound += first != last;
+            }
+        }
+    }
+    const std::chrono::duration<double> naiveElapsed = std::chrono::steady_clock::now() - begin;
+    std::printf("Anagram occurrences in text (%zu words, %zu MB text, %zu found; prefix %zu / %zu found)\n",
+        dict.size(), text.size() >> 20, scannerFound, prefixFound, naiveFound);
+    std::printf("  %-20s %10.1f MB/s\n", "AnagramScanner", static_cast<double>(text.size()) / 1e6 / scannerElapsed.count());
+    std::printf("  %-20s %10.1f MB/s\n\n", "every substring", static_cast<double>(prefixSize) / 1e6 / naiveElapsed.count());
+}
+
+void benchmarkSubAnagrams() {
+    algos::FlatAnagramDict dict;
+    for (const auto &word : makeWords(1000000, 6)) {
+        dict.insert(word);
+    }
+    const algos::SubAnagramIndex index{dict};
+
+    // baseline: letter counts of every anagram class, precomputed, checked one by one
+    using Counts = std::array<std::uint8_t, 26>;
+    std::vector<std::pair<Counts, std::vector<std::string_view> > > classes;
+    dict.forEachRun([&](const auto &, auto first, auto last) {
+        Counts counts{};
+        for (auto c : *first) {
+            ++counts[static_cast<std::size_t>(c - 'a')];
+        }
+        classes.push_back({counts, {first, last}});
+    });
+
+    const auto queries = makeWords(200, 7);
+    const auto timeQueries = [&](auto findSubAnagrams) {
+        std::vector<std::string_view> found;
+        const auto begin = std::chrono::steady_clock::now();
+        for (const auto &query : queries) {
+            findSubAnagrams(query, found);
+        }
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - begin;
+        return std::make_pair(static_cast<double>(queries.size()) / elapsed.count(), found.size());
+    };
+    const auto [scanRate, scanFound] = timeQueries([&](const std::string &query, auto &found) {
+        Counts available{};
+        for (auto c : query) {
+            ++available[static_cast<std::size_t>(c - 'a')];
+        }
+        for (const auto &[counts, words] : classes) {
+            bool fits = true;
+            for (std::size_t i = 0; i < counts.size(); ++i) {
+                fits &= counts[i] <= available[i];
+            }
+            if (fits) {
+                found.insert(found.end(), words.begin(), words.end());
+            }
+        }
+    });
+    const auto [indexRate, indexFound] = timeQueries([&](const std::string &query, auto &found) {
+        index.findSubAnagrams(query, std::back_inserter(found));
+    });
+    std::printf("Sub-anagram queries (%zu words, %zu classes, index %.1f MB, %zu / %zu found)\n",
+        dict.size(), classes.size(), static_cast<double>(index.memoryUsage()) / 1e6, scanFound, indexFound);
+    std::printf("  %-20s %10.1f queries/s\n", "linear scan", scanRate);
+    std::printf("  %-20s %10.1f queries/s\n\n", "SubAnagramIndex", indexRate);
+}
+
+} // anonymous namespace
+
+int main(int argc, char *argv[]) {
+    const std::chrono::milliseconds duration{argc > 1 ? std::atoi(argv[1]) : 200};
+    benchmarkBatchLookup();
+    benchmarkKeyFilter();
+    benchmarkScanner();
+    benchmarkSubAnagrams();
+
+    const auto words = makeWords(200000, 1);
+    const auto newWords = makeWords(20000, 2);
+    const auto queries = makeWords(50000, 3);
+
+    algos::ConcurrentAnagramDict concurrentDict;
+    SharedMutexAnagramDict sharedMutexDict;
+    for (const auto &word : words) {
+        concurrentDict.insert(word);
+        sharedMutexDict.insert(word);
+    }
+
+    const unsigned maxThreads = std::max(1u, std::thread::hardware_concurrency());
+    std::printf("%-22s %8s %6s %14s\n", "dict", "threads", "read%", "Mops/s");
+    for (unsigned readPercent : {100u, 99u, 95u, 90u, 50u}) {
+        for (unsigned threads = 1; ; threads = std::min(threads * 2, maxThreads)) {
+            const auto concurrentOps = measure(concurrentDict, queries, newWords, threads, readPercent, duration);
+            const auto sharedMutexOps = measure(sharedMutexDict, queries, newWords, threads, readPercent, duration);
+            std::printf("%-22s %8u %6u %14.3f\n", "ConcurrentAnagramDict", threads, readPercent, concurrentOps / 1e6);
+            std::printf("%-22s %8u %6u %14.3f\n", "shared_mutex+multimap", threads, readPercent, sharedMutexOps / 1e6);
+            if (threads == maxThreads) {
+                break;
+            }
+        }
+    }
+    return 0;
+}
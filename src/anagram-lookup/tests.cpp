@@ -1,7 +1,28 @@
+#include "Alphabet.hpp"
 #include "AnagramDict.hpp"
-#include <gtest/gtest.h>
-#include <iostream>
+#include "AnagramDictSnapshot.hpp"
+#include "AnagramScanner.hpp"
+#include "ConcurrentAnagramDict.hpp"
+#include "EpochDomain.hpp"
+#include "FlatAnagramDict.hpp"
+#include "FlatAnagramDictBuilder.hpp"
+#include "LetterCountKernels.hpp"
+#include "SubAnagramIndex.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <fstream>
 #include <iterator>
+#include <random>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <tuple>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include <fcntl.h> // open
+#include <unistd.h> // close
 
 namespace {
 
@@ -15,23 +36,815 @@ TEST(AnagramDict, FindsAllAnagrams) {
     dict.insert("ala");
     dict.insert("dog");
     //TODO test with (relocated) spaces too
-    EXPECT_THROW(
-        dict.insert("cccccccaaccaaaaac"),
-        std::invalid_argument
-    );
 
     auto [anagramsBegin, anagramsEnd] = dict.findAnagrams("dGO"); //odg
     //ASSERT_NEQ(); //TODO add end() iterator
 
     EXPECT_EQ(3, std::distance(anagramsBegin, anagramsEnd));
 
+    std::vector<std::string> anagrams;
     for (auto it = anagramsBegin; it != anagramsEnd; ++it) {
-        //TODO add assertions -- unknown order
-        std::cout << it->second << ' ' << it->first << '\n';
+        anagrams.push_back(it->second);
+    }
+    std::sort(anagrams.begin(), anagrams.end()); // unknown order
+    EXPECT_EQ(
+        (std::vector<std::string>{"God", "dog", "odg"}),
+        anagrams
+    );
+}
+
+TEST(AnagramDict, DoesNotFindNonAnagrams) {
+    algos::AnagramDict dict;
+    dict.insert("dog");
+    dict.insert("good");
+    dict.insert("do");
+
+    auto [anagramsBegin, anagramsEnd] = dict.findAnagrams("gdd");
+
+    EXPECT_EQ(0, std::distance(anagramsBegin, anagramsEnd));
+}
+
+TEST(AnagramDict, HasNoLimitOnLetterOccurrences) {
+    algos::AnagramDict dict;
+    dict.insert("cccccccaaccaaaaac"); // 10 x 'c'
+    dict.insert("aaaaaaaaaaaaaaaaaaaab"); // 20 x 'a', overflows the packed signature
+    dict.insert("aaaaaaaaaaaaaaaaaaaac");
+
+    auto [ccBegin, ccEnd] = dict.findAnagrams("aaaaaaacccccccccc");
+    ASSERT_EQ(1, std::distance(ccBegin, ccEnd));
+    EXPECT_EQ("cccccccaaccaaaaac", ccBegin->second);
+
+    auto [aaBegin, aaEnd] = dict.findAnagrams("baaaaaaaaaaaaaaaaaaaa");
+    ASSERT_EQ(1, std::distance(aaBegin, aaEnd));
+    EXPECT_EQ("aaaaaaaaaaaaaaaaaaaab", aaBegin->second);
+}
+
+TEST(AnagramDict, ThrowsOnNonLetterCharacters) {
+    algos::AnagramDict dict;
+    EXPECT_THROW(
+        dict.insert("dog house"),
+        std::invalid_argument
+    );
+    EXPECT_THROW(
+        dict.findAnagrams("d0g"),
+        std::invalid_argument
+    );
+}
+
+TEST(AnagramDict, WorksWithStringKeyCalculator) {
+    algos::BasicAnagramDict<algos::AnagramStringKeyCalculator> dict;
+    dict.insert("God");
+    dict.insert("ala");
+    dict.insert("dog");
+
+    auto [anagramsBegin, anagramsEnd] = dict.findAnagrams("dGO");
+
+    EXPECT_EQ(2, std::distance(anagramsBegin, anagramsEnd));
+    EXPECT_EQ("DGO", anagramsBegin->first);
+}
+
+TEST(AnagramDict, FindsAnagramsInBatches) {
+    algos::AnagramDict dict;
+    algos::FilteredAnagramDict filtered;
+    for (const auto *word : {"God", "ala", "dog", "aaaaaaaaaaaaaaaaaaaab"}) {
+        dict.insert(word);
+        filtered.insert(word);
+    }
+    std::vector<std::string> queries;
+    for (int i = 0; i < 100; ++i) { // more than one block
+        queries.push_back(i % 3 == 0 ? "oDg" : i % 3 == 1 ? "cat" : "baaaaaaaaaaaaaaaaaaaa");
+    }
+
+    std::vector<std::pair<algos::AnagramDict::const_iterator, algos::AnagramDict::const_iterator> > results;
+    dict.findAnagramsBatch(queries.begin(), queries.end(), std::back_inserter(results));
+    std::vector<std::pair<algos::FilteredAnagramDict::const_iterator, algos::FilteredAnagramDict::const_iterator> >
+        filteredResults;
+    filtered.findAnagramsBatch(queries.begin(), queries.end(), std::back_inserter(filteredResults));
+
+    ASSERT_EQ(queries.size(), results.size());
+    ASSERT_EQ(queries.size(), filteredResults.size());
+    for (std::size_t i = 0; i < queries.size(); ++i) {
+        EXPECT_EQ(dict.findAnagrams(queries[i]), results[i]) << queries[i];
+        EXPECT_EQ(filtered.findAnagrams(queries[i]), filteredResults[i]) << queries[i];
+    }
+    std::vector<std::string_view> invalid{"dog", "do g"};
+    EXPECT_THROW(dict.findAnagramsBatch(invalid.begin(), invalid.end(), std::back_inserter(results)),
+        std::invalid_argument);
+}
+
+TEST(AnagramSignatureKeyCalculator, PacksLetterCountsIntoNibbles) {
+    algos::AnagramSignatureKeyCalculator calculator;
+
+    auto signature = calculator.calculateKey("abZz");
+
+    EXPECT_EQ(0x11u, signature.low); // 'A' -> nibble 0, 'B' -> nibble 1
+    EXPECT_EQ(0x2ull << (9 * 4), signature.high); // 'Z' -> nibble 9 of high
+    EXPECT_FALSE(signature.overflowed());
+    EXPECT_TRUE(calculator.calculateKey(std::string(16, 'e')).overflowed());
+    EXPECT_FALSE(calculator.calculateKey(std::string(15, 'e')).overflowed());
+}
+
+TEST(AnagramSignatureKeyCalculator, EncodesOverflowedCountsExactly) {
+    algos::AnagramSignatureKeyCalculator calculator;
+    const std::string alphabet = "abcdefghijklmnopqrstuvwxyz";
+    std::mt19937 random{7};
+    std::vector<std::pair<std::string, algos::LetterCountSignature> > keys;
+    for (int i = 0; i < 2000; ++i) {
+        std::string word(16, alphabet[random() % alphabet.size()]); // overflowed
+        const auto size = random() % (80 - 16 + 1);
+        for (std::size_t j = 0; j < size; ++j) {
+            word += alphabet[random() % alphabet.size()];
+        }
+        const auto key = calculator.calculateKey(word);
+        ASSERT_TRUE(key.overflowed()) << word;
+        EXPECT_EQ(0u, key.high & algos::LetterCountSignature::fingerprintFlag) << word;
+        std::sort(word.begin(), word.end());
+        keys.emplace_back(word, key);
+    }
+    for (std::size_t i = 0; i < keys.size(); ++i) {
+        for (std::size_t j = 0; j < i; ++j) {
+            EXPECT_EQ(keys[i].first == keys[j].first, keys[i].second == keys[j].second)
+                << keys[i].first << ' ' << keys[j].first;
+        }
+    }
+
+    std::string huge;
+    for (auto c : alphabet) {
+        huge += std::string(1000, c);
+    }
+    const auto fingerprint = calculator.calculateKey(huge);
+    EXPECT_TRUE(fingerprint.overflowed());
+    EXPECT_NE(0u, fingerprint.high & algos::LetterCountSignature::fingerprintFlag);
+    EXPECT_EQ(fingerprint, calculator.calculateKey(huge.substr(1) + 'a'));
+}
+
+TEST(Alphabet, BuildsIndexTablesAtCompileTime) {
+    using Letters = algos::AlphabetTraits<algos::AsciiLetters>;
+    static_assert(Letters::indexTable['a'] == 0 && Letters::indexTable['Z'] == 25);
+    static_assert(Letters::indexTable['1'] == Letters::notASymbol);
+    using ByFrequency = algos::AlphabetTraits<algos::EnglishFrequencyLetters>;
+    static_assert(ByFrequency::indexTable['e'] == 0 && ByFrequency::indexTable['Z'] == 25);
+    using Digits = algos::AlphabetTraits<algos::Digits>;
+    static_assert(Digits::size == 10 && Digits::indexTable['7'] == 7 && Digits::indexTable['a'] == Digits::notASymbol);
+    using Bytes = algos::AlphabetTraits<algos::Bytes>;
+    static_assert(Bytes::size == 256 && Bytes::indexTable[0xFF] == 0xFF && Bytes::indexTable[0] == 0);
+    static_assert(Bytes::notASymbol > 0xFF);
+
+    EXPECT_EQ(4u, Digits::indexOf('4'));
+    EXPECT_THROW(Digits::indexOf('x'), std::invalid_argument);
+}
+
+TEST(AnagramSignatureKeyCalculator, WorksWithDigits) {
+    algos::BasicFlatAnagramDict<algos::DigitSignatureKeyCalculator> dict;
+    for (const auto *number : {"1234", "4321", "1243", "1123", "3211", "0"}) {
+        dict.insert(number);
+    }
+    const std::vector<std::string_view> queries{"2413", "1231", "0", "5"};
+    std::vector<std::pair<algos::BasicFlatAnagramDict<algos::DigitSignatureKeyCalculator>::const_iterator,
+        algos::BasicFlatAnagramDict<algos::DigitSignatureKeyCalculator>::const_iterator> > results(queries.size());
+    dict.findAnagramsBatch(queries.begin(), queries.end(), results.begin());
+
+    EXPECT_EQ(3, results[0].second - results[0].first);
+    EXPECT_EQ(2, results[1].second - results[1].first);
+    EXPECT_EQ(1, results[2].second - results[2].first);
+    EXPECT_EQ(0, results[3].second - results[3].first);
+    dict.insert(std::string(20, '9')); // overflowed signature
+    auto [first, last] = dict.findAnagrams(std::string(20, '9'));
+    EXPECT_EQ(1, last - first);
+    EXPECT_THROW(dict.findAnagrams("12a"), std::invalid_argument);
+}
+
+TEST(AnagramStringKeyCalculator, SortsSymbolsInAlphabetOrder) {
+    EXPECT_EQ("EETR", algos::BasicAnagramStringKeyCalculator<algos::EnglishFrequencyLetters>{}.calculateKey("tree"));
+    EXPECT_EQ("EERT", algos::AnagramStringKeyCalculator{}.calculateKey("Tree"));
+
+    algos::BasicAnagramDict<algos::ByteStringKeyCalculator> dict; // case-sensitive, any bytes
+    dict.insert("\xC5\xBC\xC3\xB3\xC5\x82w");
+    dict.insert("w\xC5\x82\xC3\xB3\xC5\xBC");
+    dict.insert("W\xC5\x82\xC3\xB3\xC5\xBC");
+    auto [first, last] = dict.findAnagrams("\xC5\xC5\xC3\xBC\x82\xB3w");
+    EXPECT_EQ(2, std::distance(first, last));
+}
+
+TEST(LetterCountKernels, AllKernelsAgreeWithScalarKernel) {
+    std::vector<algos::detail::PackShortWordFn> kernels{algos::detail::packShortWord};
+#ifdef ALGORITHMS_LETTER_COUNT_KERNELS_X86
+    kernels.push_back(algos::detail::packShortWordSse2);
+    if (__builtin_cpu_supports("avx2")) {
+        kernels.push_back(algos::detail::packShortWordAvx2);
+    }
+#endif
+    std::mt19937 random{42};
+    const std::string alphabet = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ";
+    for (int i = 0; i < 2000; ++i) {
+        std::string word(random() % (algos::detail::maxShortWordSize + 1), ' ');
+        for (auto &c : word) {
+            c = alphabet[random() % alphabet.size()];
+        }
+        std::uint64_t expectedLow = 0, expectedHigh = 0;
+        ASSERT_TRUE(algos::detail::packShortWordScalar(word.data(), word.size(), expectedLow, expectedHigh));
+        for (auto kernel : kernels) {
+            std::uint64_t low = 0, high = 0;
+            ASSERT_TRUE(kernel(word.data(), word.size(), low, high)) << word;
+            EXPECT_EQ(expectedLow, low) << word;
+            EXPECT_EQ(expectedHigh, high) << word;
+        }
+    }
+    for (auto kernel : kernels) {
+        std::uint64_t low = 0, high = 0;
+        for (std::string invalid : {"ab@", "[ab", "a b", "ab`", "z{", "\xc1x", "e\xe9"}) {
+            EXPECT_FALSE(kernel(invalid.data(), invalid.size(), low, high)) << invalid;
+        }
+    }
+}
+
+TEST(AnagramDict, ReportsMemoryUsage) {
+    algos::AnagramDict dict;
+    EXPECT_EQ(0u, dict.size());
+    dict.insert("dog");
+    dict.insert("supercalifragilistic"); // does not fit in the small string buffer
+
+    EXPECT_EQ(2u, dict.size());
+    EXPECT_GE(dict.memoryUsage(), 2 * sizeof(algos::AnagramDict::value_type) + 21);
+}
+
+TEST(BlockedBloomFilter, HasNoFalseNegativesAndReportsFalsePositiveRate) {
+    algos::BlockedBloomFilter filter{10, 10000};
+    for (std::uint64_t i = 0; i < 10000; ++i) {
+        filter.insert(i * 0x9E3779B97F4A7C15ULL);
+    }
+    std::size_t falsePositives = 0;
+    for (std::uint64_t i = 0; i < 10000; ++i) {
+        EXPECT_TRUE(filter.mayContain(i * 0x9E3779B97F4A7C15ULL));
+        falsePositives += filter.mayContain((i + 10000) * 0x9E3779B97F4A7C15ULL);
+    }
+
+    EXPECT_EQ(7u, filter.hashCount());
+    EXPECT_GT(filter.size(), 9900u);
+    EXPECT_LE(filter.memoryUsage(), 2 * 10000 * 10 / 8);
+    const auto rate = filter.falsePositiveRate();
+    EXPECT_GT(rate, 0.0);
+    EXPECT_LT(rate, 0.02);
+    EXPECT_NEAR(rate, static_cast<double>(falsePositives) / 10000, 0.01);
+    EXPECT_THROW(algos::BlockedBloomFilter{0.5}, std::invalid_argument);
+}
+
+TEST(AnagramDict, FindsSameAnagramsWithKeyFilter) {
+    algos::AnagramDict dict;
+    algos::FilteredAnagramDict filteredDict{algos::BlockedBloomFilter{8}};
+    std::mt19937 random{9};
+    std::vector<std::string> words(6000); // the last 1000 are not inserted - mostly missing keys
+    for (auto &word : words) {
+        word.resize(2 + random() % 6);
+        for (auto &c : word) {
+            c = static_cast<char>('a' + random() % 26);
+        }
+    }
+    for (std::size_t i = 0; i < 5000; ++i) {
+        dict.insert(words[i]);
+        filteredDict.insert(words[i]);
+    }
+
+    EXPECT_EQ(8.0, filteredDict.keyFilter().bitsPerKey());
+    EXPECT_GE(filteredDict.keyFilter().capacity(), filteredDict.keyFilter().size());
+    EXPECT_GT(filteredDict.memoryUsage(), filteredDict.keyFilter().memoryUsage());
+    for (const auto &query : words) {
+        auto [first, last] = dict.findAnagrams(query);
+        auto [filteredFirst, filteredLast] = filteredDict.findAnagrams(query);
+        std::vector<std::string> expected, found;
+        for (; first != last; ++first) {
+            expected.push_back(first->second);
+        }
+        for (; filteredFirst != filteredLast; ++filteredFirst) {
+            found.push_back(filteredFirst->second);
+        }
+        std::sort(expected.begin(), expected.end());
+        std::sort(found.begin(), found.end());
+        EXPECT_EQ(expected, found);
+    }
+}
+
+TEST(FlatAnagramDict, FindsAllAnagrams) {
+    algos::FlatAnagramDict dict;
+    dict.insert("God");
+    dict.insert("laa");
+    dict.insert("odg");
+    dict.insert("ala");
+    dict.insert("dog");
+
+    auto [anagramsBegin, anagramsEnd] = dict.findAnagrams("dGO");
+
+    EXPECT_EQ(
+        (std::vector<std::string_view>{"God", "odg", "dog"}), // insertion order within a run
+        std::vector<std::string_view>(anagramsBegin, anagramsEnd)
+    );
+    EXPECT_EQ(5u, dict.size());
+    EXPECT_EQ(2u, dict.keyCount());
+}
+
+TEST(FlatAnagramDict, DoesNotFindNonAnagrams) {
+    algos::FlatAnagramDict dict;
+    {
+        auto [anagramsBegin, anagramsEnd] = dict.findAnagrams("dog"); // empty dictionary
+        EXPECT_EQ(0, std::distance(anagramsBegin, anagramsEnd));
+    }
+    dict.insert("dog");
+    dict.insert("good");
+    {
+        auto [anagramsBegin, anagramsEnd] = dict.findAnagrams("gdd");
+        EXPECT_EQ(0, std::distance(anagramsBegin, anagramsEnd));
+    }
+}
+
+TEST(FlatAnagramDict, KeepsRunsContiguousWhenInterleavingKeys) {
+    algos::FlatAnagramDict dict;
+    std::string word = "abcdefgh";
+    std::vector<std::string> words;
+    // interleave inserts of many anagram classes to force run relocations, rehashing and compaction
+    for (int round = 0; round < 50; ++round) {
+        for (char last = 'a'; last <= 'z'; ++last) {
+            std::string value = word + last;
+            std::rotate(value.begin(), value.begin() + round % value.size(), value.end());
+            dict.insert(value);
+            if (last == 'q') {
+                words.push_back(value);
+            }
+        }
+    }
+
+    auto [anagramsBegin, anagramsEnd] = dict.findAnagrams("qhgfedcba");
+
+    EXPECT_EQ(
+        std::vector<std::string_view>(words.begin(), words.end()),
+        std::vector<std::string_view>(anagramsBegin, anagramsEnd)
+    );
+    EXPECT_EQ(50u * 26, dict.size());
+    EXPECT_EQ(26u, dict.keyCount());
+    EXPECT_GT(dict.memoryUsage(), dict.size() * (sizeof(std::uint64_t) + word.size()));
+}
+
+TEST(FlatAnagramDict, WorksWithStringKeyCalculator) {
+    algos::BasicFlatAnagramDict<algos::AnagramStringKeyCalculator> dict;
+    dict.insert("God");
+    dict.insert("ala");
+    dict.insert("dog");
+
+    auto [anagramsBegin, anagramsEnd] = dict.findAnagrams("dGO");
+
+    EXPECT_EQ(2, std::distance(anagramsBegin, anagramsEnd));
+    EXPECT_EQ("God", *anagramsBegin);
+}
+
+std::string makeWordList(std::size_t wordCount) {
+    std::string wordList;
+    std::string word = "listen";
+    for (std::size_t i = 0; i < wordCount; ++i) {
+        std::next_permutation(word.begin(), word.end());
+        wordList += word;
+        wordList += (i % 7 == 0) ? "\r\n" : "\n";
+        if (i % 5 == 0) {
+            wordList += std::string(1, static_cast<char>('a' + i % 26)) + "xy\n\n";
+        }
+    }
+    return wordList;
+}
+
+TEST(FlatAnagramDict, FindsAnagramsInBatches) {
+    algos::FlatAnagramDictBuilder<> builder;
+    auto dict = builder.build(makeWordList(3000));
+    dict.insert("aaaaaaaaaaaaaaaaaaaab"); // long word - not handled by the short word kernels
+    std::vector<std::string> queries;
+    for (int i = 0; i < 100; ++i) { // more than one block
+        queries.push_back(i % 3 == 0 ? "SiLeNt" : i % 3 == 1 ? "yxc" : "baaaaaaaaaaaaaaaaaaaa");
+    }
+    queries.push_back("zzz");
+
+    std::vector<std::pair<algos::FlatAnagramDict::const_iterator, algos::FlatAnagramDict::const_iterator> > results;
+    dict.findAnagramsBatch(queries.begin(), queries.end(), std::back_inserter(results));
+
+    ASSERT_EQ(queries.size(), results.size());
+    for (std::size_t i = 0; i < queries.size(); ++i) {
+        EXPECT_EQ(dict.findAnagrams(queries[i]), results[i]) << queries[i];
+    }
+    std::vector<std::string_view> invalid{"dog", "do g"};
+    EXPECT_THROW(dict.findAnagramsBatch(invalid.begin(), invalid.end(), std::back_inserter(results)),
+        std::invalid_argument);
+}
+
+TEST(FlatAnagramDict, FindsAnagramsBatchWithStringKeyCalculator) {
+    algos::BasicFlatAnagramDict<algos::AnagramStringKeyCalculator> dict;
+    dict.insert("God");
+    dict.insert("ala");
+    dict.insert("dog");
+
+    std::vector<std::string_view> queries{"odg", "cat"};
+    std::vector<std::pair<algos::BasicFlatAnagramDict<algos::AnagramStringKeyCalculator>::const_iterator,
+        algos::BasicFlatAnagramDict<algos::AnagramStringKeyCalculator>::const_iterator> > results;
+    dict.findAnagramsBatch(queries.begin(), queries.end(), std::back_inserter(results));
+    ASSERT_EQ(2u, results.size());
+    EXPECT_EQ(2, std::distance(results[0].first, results[0].second));
+    EXPECT_EQ(results[1].first, results[1].second);
+}
+
+TEST(FlatAnagramDictBuilder, BuildsSameDictAsInserts) {
+    const auto wordList = makeWordList(30000); // several chunks
+    algos::FlatAnagramDict inserted;
+    std::size_t pos = 0;
+    while (pos < wordList.size()) {
+        auto end = wordList.find('\n', pos);
+        auto word = wordList.substr(pos, end - pos);
+        if (!word.empty() && word.back() == '\r') {
+            word.pop_back();
+        }
+        if (!word.empty()) {
+            inserted.insert(word);
+        }
+        pos = end + 1;
     }
+
+    algos::FlatAnagramDictBuilder<> builder{4};
+    auto built = builder.build(wordList);
+
+    EXPECT_EQ(inserted.size(), built.size());
+    EXPECT_EQ(inserted.keyCount(), built.keyCount());
+    EXPECT_EQ(inserted.size(), builder.stats().words);
+    EXPECT_EQ(inserted.keyCount(), builder.stats().keys);
+    for (std::string query : {"silent", "xay", "xyz", "yxb", "tinsel", "dog"}) {
+        auto [insertedBegin, insertedEnd] = inserted.findAnagrams(query);
+        auto [builtBegin, builtEnd] = built.findAnagrams(query);
+        EXPECT_EQ(
+            std::vector<std::string_view>(insertedBegin, insertedEnd),
+            std::vector<std::string_view>(builtBegin, builtEnd)
+        ) << query;
+    }
+    built.insert("enlist"); // built dictionary stays insertable
+    auto [builtBegin, builtEnd] = built.findAnagrams("silent");
+    EXPECT_EQ("enlist", *std::prev(builtEnd));
 }
 
-//TODO test
-// DoesNotFindNonAnagrams
+TEST(FlatAnagramDictBuilder, BuildsFromFile) {
+    const auto path = testing::TempDir() + "anagramDictWordList.txt";
+    {
+        std::ofstream file{path, std::ios::binary};
+        file << "God\nodg\nala\ndog"; // no trailing newline
+    }
+
+    algos::FlatAnagramDictBuilder<> builder;
+    auto dict = builder.buildFromFile(path);
+    std::remove(path.c_str());
+
+    auto [anagramsBegin, anagramsEnd] = dict.findAnagrams("dGO");
+    EXPECT_EQ(
+        (std::vector<std::string_view>{"God", "odg", "dog"}),
+        std::vector<std::string_view>(anagramsBegin, anagramsEnd)
+    );
+    EXPECT_EQ(4u, builder.stats().words);
+    EXPECT_GE(builder.stats().wordsPerSecond(), 0.0);
+}
+
+TEST(FlatAnagramDictBuilder, HandlesEmptyInputAndErrors) {
+    algos::FlatAnagramDictBuilder<> builder{2};
+    auto dict = builder.build("");
+    EXPECT_EQ(0u, dict.size());
+    auto [anagramsBegin, anagramsEnd] = dict.findAnagrams("dog");
+    EXPECT_EQ(anagramsBegin, anagramsEnd);
+
+    EXPECT_THROW(builder.build("dog\nhot dog\n"), std::invalid_argument);
+    EXPECT_THROW(builder.buildFromFile(testing::TempDir() + "no/such/file"), std::system_error);
+}
+
+TEST(AnagramDictSnapshot, FindsSameAnagramsAsSavedDict) {
+    const auto path = testing::TempDir() + "anagramDictSnapshot.bin";
+    algos::FlatAnagramDictBuilder<> builder;
+    auto dict = builder.build(makeWordList(2000));
+    dict.insert("aaaaaaaaaaaaaaaaaaaab"); // overflowed signature
+
+    algos::saveSnapshot(dict, path);
+    algos::AnagramDictSnapshot snapshot{path};
+    std::remove(path.c_str()); // the mapping stays valid
+
+    EXPECT_EQ(dict.size(), snapshot.size());
+    EXPECT_EQ(dict.keyCount(), snapshot.keyCount());
+    for (std::string query : {"silent", "xay", "yxb", "dog", "baaaaaaaaaaaaaaaaaaaa"}) {
+        auto [dictBegin, dictEnd] = dict.findAnagrams(query);
+        auto [snapshotBegin, snapshotEnd] = snapshot.findAnagrams(query);
+        EXPECT_EQ(
+            std::vector<std::string_view>(dictBegin, dictEnd),
+            std::vector<std::string_view>(snapshotBegin, snapshotEnd)
+        ) << query;
+    }
+}
+
+TEST(AnagramDictSnapshot, SavesNodeBasedDict) {
+    const auto path = testing::TempDir() + "anagramDictSnapshotMultimap.bin";
+    algos::AnagramDict dict;
+    dict.insert("God");
+    dict.insert("ala");
+    dict.insert("dog");
+
+    algos::saveSnapshot(dict, path);
+    algos::AnagramDictSnapshot snapshot{path};
+    std::remove(path.c_str());
+
+    auto [anagramsBegin, anagramsEnd] = snapshot.findAnagrams("dGO");
+    std::vector<std::string> anagrams(anagramsBegin, anagramsEnd);
+    std::sort(anagrams.begin(), anagrams.end());
+    EXPECT_EQ(
+        (std::vector<std::string>{"God", "dog"}),
+        anagrams
+    );
+    auto [noneBegin, noneEnd] = snapshot.findAnagrams("cat");
+    EXPECT_EQ(noneBegin, noneEnd);
+}
+
+TEST(AnagramDictSnapshot, RejectsWordsOverLimits) {
+    const auto path = testing::TempDir() + "anagramDictSnapshotTooLong.bin";
+    algos::AnagramDict dict;
+    dict.insert("dog");
+    dict.insert(std::string(std::size_t{1} << 24, 'a')); // the length does not fit in a word reference
+
+    EXPECT_THROW(algos::saveSnapshot(dict, path), std::length_error);
+    EXPECT_FALSE(std::ifstream{path}.is_open()); // nothing written
+}
+
+TEST(AnagramDictSnapshot, RejectsDifferentAlphabet) {
+    const auto path = testing::TempDir() + "anagramDictSnapshotDigits.bin";
+    algos::BasicFlatAnagramDict<algos::DigitSignatureKeyCalculator> dict;
+    dict.insert("1203");
+    dict.insert("3021");
+
+    algos::saveSnapshot(dict, path);
+    EXPECT_THROW(algos::AnagramDictSnapshot{path}, std::runtime_error); // same key type, letters alphabet
+    algos::BasicAnagramDictSnapshot<algos::DigitSignatureKeyCalculator> snapshot{path};
+    std::remove(path.c_str());
+
+    auto [anagramsBegin, anagramsEnd] = snapshot.findAnagrams("0123");
+    EXPECT_EQ(
+        (std::vector<std::string>{"1203", "3021"}),
+        std::vector<std::string>(anagramsBegin, anagramsEnd)
+    );
+}
+
+TEST(AnagramDictSnapshot, RejectsInvalidFiles) {
+    const auto path = testing::TempDir() + "anagramDictNotASnapshot.bin";
+    {
+        std::ofstream file{path, std::ios::binary};
+        file << "God\nodg\nala\ndog\n";
+    }
+    EXPECT_THROW(algos::AnagramDictSnapshot{path}, std::runtime_error);
+    std::remove(path.c_str());
+}
+
+TEST(EpochDomain, ReclaimsRetiredObjectsOfAllThreads) {
+    static std::atomic<std::size_t> deleted{0};
+    const auto deleter = [](void *ptr) {
+        delete static_cast<int *>(ptr);
+        deleted.fetch_add(1);
+    };
+    auto &domain = algos::EpochDomain::instance();
+    domain.collect();
+    const auto deletedBefore = deleted.load();
+    const auto retireFromThreads = [&] {
+        std::vector<std::thread> writers;
+        for (int t = 0; t < 4; ++t) {
+            writers.emplace_back([&] {
+                for (int i = 0; i < 300; ++i) { // several reclaim thresholds
+                    domain.retire(new int{i}, deleter);
+                }
+            });
+        }
+        for (auto &writer : writers) {
+            writer.join();
+        }
+    };
+
+    {
+        algos::EpochDomain::Guard guard; // may still see everything retired from now on
+        retireFromThreads();
+        domain.collect();
+        EXPECT_EQ(deletedBefore, deleted.load());
+    }
+    retireFromThreads();
+    domain.collect();
+    EXPECT_EQ(deletedBefore + 2 * 4 * 300, deleted.load());
+    EXPECT_EQ(0u, domain.pendingCount());
+}
+
+TEST(ConcurrentAnagramDict, FindsAllAnagrams) {
+    algos::ConcurrentAnagramDict dict;
+    dict.insert("God");
+    dict.insert("laa");
+    dict.insert("odg");
+    dict.insert("ala");
+    dict.insert("dog");
+
+    auto anagrams = dict.findAnagrams("dGO");
+    EXPECT_EQ(
+        (std::vector<std::string>{"God", "odg", "dog"}),
+        std::vector<std::string>(anagrams.begin(), anagrams.end())
+    );
+    EXPECT_TRUE(dict.findAnagrams("cat").empty());
+    EXPECT_EQ(5u, dict.size());
+}
+
+TEST(ConcurrentAnagramDict, ReadersSeeConsistentRunsWhileWritersInsert) {
+    algos::ConcurrentAnagramDict dict;
+    constexpr int wordsPerWriter = 2000;
+    std::atomic<bool> done{false};
+    std::atomic<bool> inconsistent{false};
+
+    std::vector<std::thread> readers;
+    for (int r = 0; r < 3; ++r) {
+        readers.emplace_back([&] {
+            while (!done.load()) {
+                for (auto query : {"abc", "xyz", "listen"}) {
+                    auto anagrams = dict.findAnagrams(query);
+                    for (const auto &word : anagrams) {
+                        if (word.size() != std::string_view{query}.size()) {
+                            inconsistent = true;
+                        }
+                    }
+                }
+            }
+        });
+    }
+    std::vector<std::thread> writers;
+    for (int w = 0; w < 2; ++w) {
+        writers.emplace_back([&dict, w] {
+            std::string word = w == 0 ? "abc" : "silent";
+            for (int i = 0; i < wordsPerWriter; ++i) {
+                std::next_permutation(word.begin(), word.end());
+                dict.insert(word);
+                dict.insert(std::string(1, static_cast<char>('a' + i % 26)) + "q" + word);
+            }
+        });
+    }
+    for (auto &writer : writers) {
+        writer.join();
+    }
+    done = true;
+    for (auto &reader : readers) {
+        reader.join();
+    }
+
+    EXPECT_FALSE(inconsistent);
+    EXPECT_EQ(4u * wordsPerWriter, dict.size());
+    EXPECT_EQ(static_cast<std::size_t>(wordsPerWriter), dict.findAnagrams("cab").size());
+    EXPECT_EQ(static_cast<std::size_t>(wordsPerWriter), dict.findAnagrams("tinsel").size());
+}
+
+TEST(SubAnagramIndex, FindsWordsBuildableFromLetters) {
+    algos::FlatAnagramDict dict;
+    for (std::string word : {"a", "at", "ta", "tea", "eat", "ate", "tee", "beat", "bat", "tab", "zoo", "Tat"}) {
+        dict.insert(word);
+    }
+    algos::SubAnagramIndex index{dict};
+    EXPECT_EQ(dict.size(), index.size());
+
+    std::vector<std::string_view> found;
+    index.findSubAnagrams("TAEB", std::back_inserter(found));
+    std::sort(found.begin(), found.end());
+    EXPECT_EQ(
+        (std::vector<std::string_view>{"a", "at", "ate", "bat", "beat", "eat", "ta", "tab", "tea"}),
+        found
+    );
+
+    found.clear();
+    index.findSubAnagrams("", std::back_inserter(found));
+    EXPECT_TRUE(found.empty());
+    EXPECT_THROW(index.findSubAnagrams("ta!", std::back_inserter(found)), std::invalid_argument);
+}
+
+TEST(SubAnagramIndex, AgreesWithLinearScan) {
+    algos::AnagramDict dict; // also works on the node-based dictionary
+    std::mt19937 random{7};
+    std::vector<std::string> words;
+    for (int i = 0; i < 3000; ++i) {
+        std::string word(1 + random() % 7, ' ');
+        for (auto &c : word) {
+            c = static_cast<char>('a' + random() % 8);
+        }
+        words.push_back(word);
+        dict.insert(word);
+    }
+    words.push_back(std::string(20, 'a')); // overflowed signature
+    dict.insert(words.back());
+    words.push_back(std::string(300, 'b') + "c"); // count saturated in the index
+    dict.insert(words.back());
+    algos::SubAnagramIndex index{dict};
+
+    for (const std::string &letters : std::vector<std::string>{"abcdefgh", "aabbccdd", "hhhgg",
+            std::string(25, 'a') + "bc", std::string(300, 'b') + "ac", std::string(299, 'b') + "c"}) {
+        std::vector<std::string_view> found;
+        index.findSubAnagrams(letters, std::back_inserter(found));
+        std::vector<std::string_view> expected;
+        for (const auto &word : words) {
+            std::string rest = letters;
+            const bool buildable = std::all_of(word.begin(), word.end(), [&rest](char c) {
+                const auto pos = rest.find(c);
+                return pos != std::string::npos && (rest.erase(pos, 1), true);
+            });
+            if (buildable) {
+                expected.push_back(word);
+            }
+        }
+        std::sort(found.begin(), found.end());
+        std::sort(expected.begin(), expected.end());
+        EXPECT_EQ(expected, found) << letters;
+    }
+}
+
+TEST(SubAnagramIndex, WorksOnEmptyDict) {
+    algos::FlatAnagramDict dict;
+    algos::SubAnagramIndex index{dict};
+    std::vector<std::string_view> found;
+    index.findSubAnagrams("abc", std::back_inserter(found));
+    EXPECT_TRUE(found.empty());
+}
+
+TEST(AnagramScanner, FindsAllWindowsThatAreAnagrams) {
+    algos::FlatAnagramDict dict;
+    for (const auto *word : {"dog", "god", "listen", "silent", "aaaaaaaaaaaaaaaaab", "a"}) {
+        dict.insert(word);
+    }
+    algos::AnagramScanner scanner{dict};
+    const std::string text = "xGoD tinsel! baaaaaaaaaaaaaaaaaaa";
+
+    std::vector<std::tuple<std::uint64_t, std::size_t, std::vector<std::string_view> > > found;
+    scanner.scan(text.begin(), text.end(), [&](const algos::AnagramOccurrence &occurrence) {
+        found.emplace_back(occurrence.offset, occurrence.length,
+            std::vector<std::string_view>(occurrence.begin(), occurrence.end()));
+        std::sort(std::get<2>(found.back()).begin(), std::get<2>(found.back()).end());
+    });
+
+    std::vector<std::tuple<std::uint64_t, std::size_t, std::vector<std::string_view> > > expected{
+        {1, 3, {"dog", "god"}},
+        {5, 6, {"listen", "silent"}},
+        {13, 18, {"aaaaaaaaaaaaaaaaab"}}, // letter count overflowing the nibble
+    };
+    for (std::uint64_t offset = 14; offset < 33; ++offset) {
+        expected.emplace_back(offset, 1, std::vector<std::string_view>{"a"});
+    }
+    std::sort(found.begin(), found.end());
+    std::sort(expected.begin(), expected.end());
+    EXPECT_EQ(expected, found);
+    EXPECT_EQ(text.size(), scanner.offset());
+}
+
+TEST(AnagramScanner, AgreesWithFindAnagramsOnEverySubstring) {
+    algos::AnagramDict dict;
+    std::mt19937 random{11};
+    const auto randomWord = [&random](std::size_t length) {
+        std::string word(length, ' ');
+        for (auto &c : word) {
+            c = static_cast<char>('a' + random() % 4);
+        }
+        return word;
+    };
+    for (int i = 0; i < 200; ++i) {
+        dict.insert(randomWord(1 + random() % 20));
+    }
+    std::string text;
+    for (int i = 0; i < 3000; ++i) {
+        text += random() % 50 == 0 ? '.' : static_cast<char>('a' + random() % 4);
+    }
+
+    std::vector<std::pair<std::uint64_t, std::size_t> > expected;
+    for (std::size_t length = 1; length <= 20; ++length) {
+        for (std::size_t offset = 0; offset + length <= text.size(); ++offset) {
+            const auto window = text.substr(offset, length);
+            if (window.find('.') == std::string::npos) {
+                auto [first, last] = dict.findAnagrams(window);
+                if (first != last) {
+                    expected.emplace_back(offset, length);
+                }
+            }
+        }
+    }
+
+    algos::AnagramScanner scanner{dict};
+    std::vector<std::pair<std::uint64_t, std::size_t> > found;
+    const auto collect = [&found](const algos::AnagramOccurrence &occurrence) {
+        found.emplace_back(occurrence.offset, occurrence.length);
+    };
+    for (std::size_t chunk = 0; chunk < text.size(); chunk += 7) { // occurrences across chunk boundaries
+        scanner.scan(text.begin() + chunk, text.begin() + std::min(chunk + 7, text.size()), collect);
+    }
+    std::sort(expected.begin(), expected.end());
+    std::sort(found.begin(), found.end());
+    EXPECT_EQ(expected, found);
+
+    const auto path = testing::TempDir() + "anagramScannerText.txt";
+    std::ofstream{path, std::ios::binary} << text;
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    ASSERT_NE(-1, fd);
+    scanner.reset();
+    found.clear();
+    scanner.scan(fd, collect);
+    ::close(fd);
+    std::remove(path.c_str());
+    std::sort(found.begin(), found.end());
+    EXPECT_EQ(expected, found);
+}
 
 } // anonymous namespace
@@ -0,0 +1,110 @@
+/** \file
+ * \brief MappedFile implementation.
+ */
+
+#ifndef ALGORITHMS_MAPPED_FILE_HPP_INCLUDED
+#define ALGORITHMS_MAPPED_FILE_HPP_INCLUDED
+
+#include <cerrno>
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <utility> // std::exchange
+
+#include <fcntl.h> // open
+#include <sys/mman.h> // mmap, munmap, madvise
+#include <sys/stat.h> // fstat
+#include <unistd.h> // close
+
+namespace algos {
+
+/// Read-only memory mapping of a whole file (POSIX).
+/**
+ * Move-only RAII owner of the mapping. An empty file is represented by an empty mapping
+ * (data() is \c nullptr) because empty mappings are not allowed by \c mmap.
+ *
+ * Throws \c std::system_error when the file cannot be opened or mapped.
+ */
+class MappedFile {
+public:
+    MappedFile() = default;
+
+    explicit MappedFile(const std::string &path) {
+        const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd == -1) {
+            throw std::system_error{errno, std::generic_category(), "Cannot open " + path};
+        }
+        struct stat fileStat{};
+        if (::fstat(fd, &fileStat) == -1) {
+            const int error = errno;
+            ::close(fd);
+            throw std::system_error{error, std::generic_category(), "Cannot stat " + path};
+        }
+        size_ = static_cast<std::size_t>(fileStat.st_size);
+        if (size_ != 0) {
+            void *addr = ::mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+            if (addr == MAP_FAILED) {
+                const int error = errno;
+                ::close(fd);
+                throw std::system_error{error, std::generic_category(), "Cannot mmap " + path};
+            }
+            data_ = static_cast<const char *>(addr);
+        }
+        ::close(fd); // the mapping keeps its own reference to the file
+    }
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    MappedFile(MappedFile &&other) noexcept
+        : data_(std::exchange(other.data_, nullptr)), size_(std::exchange(other.size_, 0)) {}
+
+    MappedFile &operator=(MappedFile &&other) noexcept {
+        if (this != &other) {
+            unmap();
+            data_ = std::exchange(other.data_, nullptr);
+            size_ = std::exchange(other.size_, 0);
+        }
+        return *this;
+    }
+
+    ~MappedFile() {
+        unmap();
+    }
+
+    const char *data() const noexcept {
+        return data_;
+    }
+
+    std::size_t size() const noexcept {
+        return size_;
+    }
+
+    std::string_view view() const noexcept {
+        return {data_, size_};
+    }
+
+    /// Hint the kernel about the access pattern (\c MADV_SEQUENTIAL, \c MADV_WILLNEED, ...).
+    void advise(int advice) const noexcept {
+        if (data_ != nullptr) {
+            ::madvise(const_cast<char *>(data_), size_, advice);
+        }
+    }
+
+private:
+    void unmap() noexcept {
+        if (data_ != nullptr) {
+            ::munmap(const_cast<char *>(data_), size_);
+            data_ = nullptr;
+            size_ = 0;
+        }
+    }
+
+    const char *data_ = nullptr;
+    std::size_t size_ = 0;
+};
+
+} // namespace algos
+
+#endif // ALGORITHMS_MAPPED_FILE_HPP_INCLUDED
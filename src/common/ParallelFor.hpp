@@ -0,0 +1,62 @@
+/** \file
+ * \brief Dynamic parallel loop over an index range, shared by the modules.
+ */
+
+#ifndef ALGORITHMS_PARALLEL_FOR_HPP_INCLUDED
+#define ALGORITHMS_PARALLEL_FOR_HPP_INCLUDED
+
+#include <algorithm> // std::min
+#include <atomic>
+#include <cstddef>
+#include <exception> // std::exception_ptr
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace algos {
+
+namespace detail {
+
+/// Call \p fn(i) for every \c i in [0, count) using up to \p threadCount threads (including the calling one).
+/**
+ * Indices are handed out dynamically, so uneven work items are balanced between threads.
+ * The first exception thrown by \p fn stops handing out further indices and is rethrown.
+ */
+template <typename Function>
+void parallelFor(std::size_t count, unsigned threadCount, Function fn) {
+    std::atomic<std::size_t> next{0};
+    std::exception_ptr error;
+    std::mutex errorMutex;
+    auto worker = [&] {
+        for (auto i = next++; i < count; i = next++) {
+            try {
+                fn(i);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock{errorMutex};
+                if (!error) {
+                    error = std::current_exception();
+                }
+                next = count;
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    const auto threadsToStart = std::min<std::size_t>(threadCount, count);
+    for (std::size_t i = 1; i < threadsToStart; ++i) {
+        threads.emplace_back(worker);
+    }
+    worker();
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+} // namespace detail
+
+} // namespace algos
+
+#endif // ALGORITHMS_PARALLEL_FOR_HPP_INCLUDED
@@ -0,0 +1,212 @@
+/** \file
+ * \brief Batch kernels: next greater number with the same digits or the same number of set bits.
+ */
+
+#ifndef ALGORITHMS_GREATER_NUMBER_KERNELS_HPP_INCLUDED
+#define ALGORITHMS_GREATER_NUMBER_KERNELS_HPP_INCLUDED
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define ALGORITHMS_GREATER_NUMBER_KERNELS_X86 1
+#include <immintrin.h>
+#endif
+
+namespace algos {
+
+/// Outcome of a next greater number computation for one element.
+enum class NextNumberStatus : std::uint8_t {
+    found, ///< the result is the next greater number
+    none, ///< the number is the greatest one of its kind (e.g. digits in non-ascending order)
+    overflow ///< the next greater number does not fit in 64 bits
+};
+
+namespace detail {
+
+/// Next greater number with the digits of \p value in base \p FixedBase (or \p runtimeBase if \p FixedBase is 0).
+/**
+ * minGreaterSeqInPlace() on the digits, working on the number itself: the digits are extracted from the least
+ * significant one until the first descent (the pivot), the number is rebuilt from there by Horner's method
+ * with the lower digits already in reversed order.
+ */
+template <unsigned FixedBase>
+NextNumberStatus nextSameDigits(std::uint64_t value, unsigned runtimeBase, std::uint64_t &result) noexcept {
+    const std::uint64_t base = FixedBase != 0 ? FixedBase : runtimeBase;
+    std::uint64_t digits[64]; // the digits below the pivot, least significant first: non-decreasing
+    unsigned digitCount = 0;
+    std::uint64_t rest = value;
+    digits[digitCount++] = rest % base;
+    rest /= base;
+    for (;;) {
+        if (rest == 0) {
+            return NextNumberStatus::none;
+        }
+        const auto digit = rest % base;
+        rest /= base;
+        if (digit < digits[digitCount - 1]) {
+            // swap the pivot with the least digit below greater than it
+            unsigned greater = 0;
+            while (digits[greater] <= digit) {
+                ++greater;
+            }
+            std::uint64_t number = rest;
+            bool overflow = __builtin_mul_overflow(number, base, &number)
+                | __builtin_add_overflow(number, digits[greater], &number);
+            digits[greater] = digit;
+            // the lower digits, now non-ascending from the most significant, are reversed: ascending
+            for (unsigned i = 0; i < digitCount; ++i) {
+                overflow |= __builtin_mul_overflow(number, base, &number)
+                    | __builtin_add_overflow(number, digits[i], &number);
+            }
+            if (overflow) {
+                return NextNumberStatus::overflow;
+            }
+            result = number;
+            return NextNumberStatus::found;
+        }
+        digits[digitCount++] = digit;
+    }
+}
+
+/// Kernel computing nextGreaterSamePopcount() of \p count values, returning the number found.
+using NextSamePopcountFn = std::size_t (*)(const std::uint64_t *values, std::size_t count,
+    std::uint64_t *results, NextNumberStatus *statuses);
+
+/// Gosper's hack: move the lowest set bit of the lowest block of ones up by one, the rest of the block to the bottom.
+inline std::size_t nextSamePopcountScalar(const std::uint64_t *values, std::size_t count,
+        std::uint64_t *results, NextNumberStatus *statuses) {
+    std::size_t found = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+        const auto value = values[i];
+        const auto lowest = value & (0 - value);
+        const auto ripple = value + lowest; // 0 if the block reaches the top bit
+        if (value == 0 || ripple == 0) {
+            statuses[i] = value == 0 ? NextNumberStatus::none : NextNumberStatus::overflow;
+            results[i] = value;
+            continue;
+        }
+        // the block is ones [ctz, ctz + n): n - 1 of them go to the bottom
+        results[i] = ripple | ((value ^ ripple) >> 2 >> __builtin_ctzll(value));
+        statuses[i] = NextNumberStatus::found;
+        ++found;
+    }
+    return found;
+}
+
+#ifdef ALGORITHMS_GREATER_NUMBER_KERNELS_X86
+
+/// AVX2: Gosper's hack on 4 values per step, without the division:
+/// the n - 1 ones put at the bottom are (1 << (popcount(value ^ ripple) - 2)) - 1.
+__attribute__((target("avx2")))
+inline std::size_t nextSamePopcountAvx2(const std::uint64_t *values, std::size_t count,
+        std::uint64_t *results, NextNumberStatus *statuses) {
+    const __m256i nibbleCounts = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+        0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i lowNibbles = _mm256_set1_epi8(0x0F);
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i one = _mm256_set1_epi64x(1);
+    const __m256i two = _mm256_set1_epi64x(2);
+    std::size_t found = 0;
+    std::size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const __m256i value = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(values + i));
+        const __m256i lowest = _mm256_and_si256(value, _mm256_sub_epi64(zero, value));
+        const __m256i ripple = _mm256_add_epi64(value, lowest);
+        const __m256i changed = _mm256_xor_si256(value, ripple);
+        // popcount of the 64-bit lanes: nibble table lookups summed by sad
+        const __m256i bytes = _mm256_add_epi8(_mm256_shuffle_epi8(nibbleCounts, _mm256_and_si256(changed, lowNibbles)),
+            _mm256_shuffle_epi8(nibbleCounts, _mm256_and_si256(_mm256_srli_epi16(changed, 4), lowNibbles)));
+        const __m256i bits = _mm256_sad_epu8(bytes, zero);
+        // shifts of 64 or more (the failed lanes) give 0
+        const __m256i bottom = _mm256_sub_epi64(_mm256_sllv_epi64(one, _mm256_sub_epi64(bits, two)), one);
+        const __m256i next = _mm256_or_si256(ripple, bottom);
+
+        const __m256i isZero = _mm256_cmpeq_epi64(value, zero);
+        const __m256i failed = _mm256_cmpeq_epi64(ripple, zero); // zero or overflow
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(results + i), _mm256_blendv_epi8(next, value, failed));
+        const auto failedMask = static_cast<unsigned>(_mm256_movemask_pd(_mm256_castsi256_pd(failed)));
+        const auto zeroMask = static_cast<unsigned>(_mm256_movemask_pd(_mm256_castsi256_pd(isZero)));
+        for (unsigned lane = 0; lane < 4; ++lane) {
+            statuses[i + lane] = (failedMask >> lane & 1) == 0 ? NextNumberStatus::found
+                : (zeroMask >> lane & 1) != 0 ? NextNumberStatus::none : NextNumberStatus::overflow;
+        }
+        found += 4 - static_cast<std::size_t>(__builtin_popcount(failedMask));
+    }
+    return found + nextSamePopcountScalar(values + i, count - i, results + i, statuses + i);
+}
+
+#endif // ALGORITHMS_GREATER_NUMBER_KERNELS_X86
+
+/// Select the fastest kernel supported by the CPU the program runs on.
+inline NextSamePopcountFn selectNextSamePopcount() {
+#ifdef ALGORITHMS_GREATER_NUMBER_KERNELS_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return nextSamePopcountAvx2;
+    }
+#endif
+    return nextSamePopcountScalar;
+}
+
+/// Kernel chosen at program start-up.
+inline const NextSamePopcountFn nextSamePopcount = selectNextSamePopcount();
+
+} // namespace detail
+
+/// For every value, the next greater number written with the same digits in base \p base.
+/**
+ * minGreaterSeqInPlace() on the digit string of every value (without leading zeros), computed on the numbers:
+ * e.g. 1243 -> 1324, 4321 has none. Base 10 runs a kernel with the base known at compile time.
+ *
+ * \p results may be \p values (computed in place). For an element without a greater number
+ * (NextNumberStatus::none) or with one over \c UINT64_MAX (NextNumberStatus::overflow) the result is the value.
+ *
+ * Throws \c std::invalid_argument if \p base is less than 2.
+ *
+ * Complexity:
+ * - Time:  O(d) per value, d - number of its digits
+ * - Space: O(1)
+ *
+ * \return number of elements with the next greater number found
+ */
+inline std::size_t nextGreaterSameDigits(const std::uint64_t *values, std::size_t count, std::uint64_t *results,
+        NextNumberStatus *statuses, unsigned base = 10) {
+    if (base < 2) {
+        throw std::invalid_argument{"Base must be at least 2"};
+    }
+    std::size_t found = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+        std::uint64_t result = values[i];
+        const auto status = base == 10 ? detail::nextSameDigits<10>(values[i], base, result)
+            : detail::nextSameDigits<0>(values[i], base, result);
+        results[i] = result;
+        statuses[i] = status;
+        found += status == NextNumberStatus::found;
+    }
+    return found;
+}
+
+/// For every value, the next greater number with the same number of set bits.
+/**
+ * minGreaterSeqInPlace() on the 64-bit binary string of every value (leading zeros included),
+ * e.g. 0b0110 -> 0b1001. Runs 4 values per step with AVX2 when the CPU supports it.
+ *
+ * \p results may be \p values (computed in place). For 0 (NextNumberStatus::none) and for values
+ * whose lowest block of ones reaches the top bit (NextNumberStatus::overflow) the result is the value.
+ *
+ * Complexity:
+ * - Time:  O(1) per value
+ * - Space: O(1)
+ *
+ * \return number of elements with the next greater number found
+ */
+inline std::size_t nextGreaterSamePopcount(const std::uint64_t *values, std::size_t count, std::uint64_t *results,
+        NextNumberStatus *statuses) {
+    return detail::nextSamePopcount(values, count, results, statuses);
+}
+
+} // namespace algos
+
+#endif // ALGORITHMS_GREATER_NUMBER_KERNELS_HPP_INCLUDED
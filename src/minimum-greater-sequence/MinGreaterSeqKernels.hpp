@@ -0,0 +1,237 @@
+/** \file
+ * \brief Vectorized kernels of minGreaterSeqInPlace() for contiguous sequences of arithmetic types.
+ */
+
+#ifndef ALGORITHMS_MIN_GREATER_SEQ_KERNELS_HPP_INCLUDED
+#define ALGORITHMS_MIN_GREATER_SEQ_KERNELS_HPP_INCLUDED
+
+#include <algorithm> // std::partition_point, std::reverse
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+#include <utility> // std::swap
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define ALGORITHMS_MIN_GREATER_SEQ_KERNELS_X86 1
+#include <immintrin.h>
+#endif
+
+namespace algos {
+
+namespace detail {
+
+/// Arithmetic type the kernels handle: integers (except \c bool), \c float and \c double.
+template <typename T>
+struct is_kernel_type : std::bool_constant<(std::is_integral_v<T> && !std::is_same_v<T, bool>)
+    || std::is_same_v<T, float> || std::is_same_v<T, double> > {};
+
+template <typename T>
+inline constexpr bool is_kernel_type_v = is_kernel_type<T>::value;
+
+/// Character type with a standard \c std::char_traits specialization, so \c std::basic_string<T> is valid.
+/**
+ * Not \c signed char nor \c unsigned char: their \c std::char_traits relied on the generic template,
+ * which libc++ no longer provides.
+ */
+template <typename T>
+struct is_char_type : std::bool_constant<std::is_same_v<T, char> || std::is_same_v<T, wchar_t>
+#ifdef __cpp_char8_t
+    || std::is_same_v<T, char8_t>
+#endif
+    || std::is_same_v<T, char16_t> || std::is_same_v<T, char32_t> > {};
+
+/// \c std::basic_string<T>::iterator for a character type \p T, \c void (matching no iterator) otherwise.
+template <typename T, bool = is_char_type<T>::value>
+struct string_iterator {
+    using type = void;
+};
+
+template <typename T>
+struct string_iterator<T, true> {
+    using type = typename std::basic_string<T>::iterator;
+};
+
+/// Iterator known to point into contiguous storage: a pointer or an iterator
+/// of \c std::vector, \c std::basic_string (of a character type) or \c std::array.
+template <typename It, typename T = typename std::iterator_traits<It>::value_type>
+struct is_contiguous_iterator : std::bool_constant<std::is_pointer_v<It>
+    || std::is_same_v<It, typename std::vector<T>::iterator>
+    || std::is_same_v<It, typename string_iterator<T>::type>
+    || std::is_same_v<It, typename std::array<T, 1>::iterator> > {};
+
+/// Kernel returning the last i such that data[i] < data[i + 1], or \p size if there is none.
+template <typename T>
+using FindLastAscentFn = std::size_t (*)(const T *data, std::size_t size);
+
+/// Kernel reversing \p size elements of \p Size bytes each.
+using ReverseFn = void (*)(void *data, std::size_t size);
+
+template <typename T>
+std::size_t findLastAscentScalar(const T *data, std::size_t size) {
+    for (std::size_t i = size < 2 ? 0 : size - 1; i > 0; --i) {
+        if (data[i - 1] < data[i]) {
+            return i - 1;
+        }
+    }
+    return size;
+}
+
+template <std::size_t Size>
+void reverseScalar(void *data, std::size_t size) {
+    using word_type = std::conditional_t<Size == 1, std::uint8_t, std::conditional_t<Size == 2, std::uint16_t,
+        std::conditional_t<Size == 4, std::uint32_t, std::uint64_t> > >;
+    auto *const words = static_cast<word_type *>(data);
+    std::reverse(words, words + size);
+}
+
+#ifdef ALGORITHMS_MIN_GREATER_SEQ_KERNELS_X86
+
+/// Lanes of 32 bytes where the lane of \p lhs is less than the lane of \p rhs (all bits set), for type \p T.
+template <typename T>
+__attribute__((target("avx2")))
+inline __m256i lessThanAvx2(__m256i lhs, __m256i rhs) {
+    if constexpr (std::is_same_v<T, float>) {
+        return _mm256_castps_si256(_mm256_cmp_ps(_mm256_castsi256_ps(lhs), _mm256_castsi256_ps(rhs), _CMP_LT_OQ));
+    } else if constexpr (std::is_same_v<T, double>) {
+        return _mm256_castpd_si256(_mm256_cmp_pd(_mm256_castsi256_pd(lhs), _mm256_castsi256_pd(rhs), _CMP_LT_OQ));
+    } else {
+        if constexpr (std::is_unsigned_v<T>) { // signed comparison of values with flipped sign bits
+            const auto signBit = static_cast<long long>(std::uint64_t{1} << (sizeof(T) * 8 - 1));
+            __m256i flip;
+            if constexpr (sizeof(T) == 1) {
+                flip = _mm256_set1_epi8(static_cast<char>(signBit));
+            } else if constexpr (sizeof(T) == 2) {
+                flip = _mm256_set1_epi16(static_cast<short>(signBit));
+            } else if constexpr (sizeof(T) == 4) {
+                flip = _mm256_set1_epi32(static_cast<int>(signBit));
+            } else {
+                flip = _mm256_set1_epi64x(signBit);
+            }
+            lhs = _mm256_xor_si256(lhs, flip);
+            rhs = _mm256_xor_si256(rhs, flip);
+        }
+        if constexpr (sizeof(T) == 1) {
+            return _mm256_cmpgt_epi8(rhs, lhs);
+        } else if constexpr (sizeof(T) == 2) {
+            return _mm256_cmpgt_epi16(rhs, lhs);
+        } else if constexpr (sizeof(T) == 4) {
+            return _mm256_cmpgt_epi32(rhs, lhs);
+        } else {
+            return _mm256_cmpgt_epi64(rhs, lhs);
+        }
+    }
+}
+
+/// AVX2: compares 32 bytes of adjacent pairs per step, from the end; the lane of the highest mask bit wins.
+template <typename T>
+__attribute__((target("avx2")))
+std::size_t findLastAscentAvx2(const T *data, std::size_t size) {
+    constexpr std::size_t lanes = 32 / sizeof(T);
+    // pairs (i, i + 1) for i < size - 1; a block of pairs [start, start + lanes) reads data[start, start + lanes]
+    std::size_t blockEnd = size < 2 ? 0 : size - 1;
+    while (blockEnd >= lanes) {
+        const auto start = blockEnd - lanes;
+        const __m256i lhs = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + start));
+        const __m256i rhs = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + start + 1));
+        const auto mask = static_cast<std::uint32_t>(_mm256_movemask_epi8(lessThanAvx2<T>(lhs, rhs)));
+        if (mask != 0) {
+            return start + static_cast<std::size_t>(31 - __builtin_clz(mask)) / sizeof(T);
+        }
+        blockEnd = start;
+    }
+    const auto i = findLastAscentScalar(data, blockEnd + 1);
+    return i == blockEnd + 1 ? size : i;
+}
+
+/// Reverse the lanes of \p Size bytes of \p block.
+template <std::size_t Size>
+__attribute__((target("avx2")))
+inline __m256i reverseLanesAvx2(__m256i block) {
+    if constexpr (Size == 8) {
+        return _mm256_permute4x64_epi64(block, 0x1B);
+    } else if constexpr (Size == 4) {
+        return _mm256_permutevar8x32_epi32(block, _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0));
+    } else {
+        // reverse within the 128-bit halves, then swap the halves
+        const __m256i shuffle = Size == 2
+            ? _mm256_setr_epi8(14, 15, 12, 13, 10, 11, 8, 9, 6, 7, 4, 5, 2, 3, 0, 1,
+                14, 15, 12, 13, 10, 11, 8, 9, 6, 7, 4, 5, 2, 3, 0, 1)
+            : _mm256_setr_epi8(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0,
+                15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0);
+        return _mm256_permute4x64_epi64(_mm256_shuffle_epi8(block, shuffle), 0x4E);
+    }
+}
+
+/// AVX2: swaps 32-byte blocks from both ends, reversing the lanes of each block with shuffles.
+template <std::size_t Size>
+__attribute__((target("avx2")))
+void reverseAvx2(void *data, std::size_t size) {
+    auto *left = static_cast<char *>(data);
+    auto *right = left + size * Size;
+    for (; right - left >= static_cast<std::ptrdiff_t>(2 * 32); left += 32, right -= 32) {
+        const __m256i leftBlock = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(left));
+        const __m256i rightBlock = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(right - 32));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(left), reverseLanesAvx2<Size>(rightBlock));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(right - 32), reverseLanesAvx2<Size>(leftBlock));
+    }
+    reverseScalar<Size>(left, static_cast<std::size_t>(right - left) / Size);
+}
+
+#endif // ALGORITHMS_MIN_GREATER_SEQ_KERNELS_X86
+
+/// Select the fastest kernels supported by the CPU the program runs on.
+template <typename T>
+FindLastAscentFn<T> selectFindLastAscent() {
+#ifdef ALGORITHMS_MIN_GREATER_SEQ_KERNELS_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return findLastAscentAvx2<T>;
+    }
+#endif
+    return findLastAscentScalar<T>;
+}
+
+template <std::size_t Size>
+ReverseFn selectReverse() {
+#ifdef ALGORITHMS_MIN_GREATER_SEQ_KERNELS_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return reverseAvx2<Size>;
+    }
+#endif
+    return reverseScalar<Size>;
+}
+
+/// Kernels chosen at program start-up.
+template <typename T>
+inline const FindLastAscentFn<T> findLastAscent = selectFindLastAscent<T>();
+
+template <std::size_t Size>
+inline const ReverseFn reverseElements = selectReverse<Size>();
+
+/// minGreaterSeqInPlace() of \p size elements at \p data, with the boundary scan and the reversal vectorized.
+template <typename T>
+bool minGreaterSeqContiguous(T *data, std::size_t size) {
+    static_assert(is_kernel_type_v<T>);
+    const auto pivot = findLastAscent<T>(data, size);
+    if (pivot == size) {
+        return false;
+    }
+    // the suffix after pivot is non-ascending: the swapped element is its last one greater than the pivot
+    auto *const suffix = data + pivot + 1;
+    auto *const swapped = std::partition_point(suffix, data + size, [&](const T &value) {
+        return data[pivot] < value;
+    }) - 1;
+    std::swap(data[pivot], *swapped);
+    reverseElements<sizeof(T)>(suffix, size - pivot - 1);
+    return true;
+}
+
+} // namespace detail
+
+} // namespace algos
+
+#endif // ALGORITHMS_MIN_GREATER_SEQ_KERNELS_HPP_INCLUDED
@@ -0,0 +1,222 @@
+/** \file
+ * \brief Run-length encoded sequence with minGreaterSeqInPlace() working on its runs.
+ */
+
+#ifndef ALGORITHMS_RUN_LENGTH_SEQ_HPP_INCLUDED
+#define ALGORITHMS_RUN_LENGTH_SEQ_HPP_INCLUDED
+
+#include <algorithm> // std::partition_point, std::reverse
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <type_traits>
+#include <utility> // std::move
+#include <vector>
+
+namespace algos {
+
+/// Run of \c count equal elements \c value.
+template <typename T>
+struct Run {
+    T value;
+    std::uint64_t count;
+};
+
+/// Sequence stored as runs of equal elements, for long sequences of few distinct values.
+/**
+ * Adjacent runs always hold different values (neither is less than the other) and no run is empty,
+ * so a sequence over k distinct values with r runs takes O(r) memory whatever its length.
+ * The elements are read through bidirectional iterators expanding the runs on the fly.
+ *
+ * \tparam T element type, must meet the requirements of
+ *   <a href="https://en.cppreference.com/w/cpp/named_req/LessThanComparable">LessThanComparable</a>
+ */
+template <typename T>
+class RunLengthSeq {
+public:
+    using value_type = T;
+    using size_type = std::uint64_t;
+
+    /// Read-only bidirectional iterator over the elements: a run and a position in it.
+    class const_iterator {
+    public:
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const T *;
+        using reference = const T &;
+
+        const_iterator() = default;
+
+        reference operator*() const noexcept {
+            return (*runs_)[run_].value;
+        }
+
+        pointer operator->() const noexcept {
+            return &(*runs_)[run_].value;
+        }
+
+        const_iterator &operator++() noexcept {
+            if (++offset_ == (*runs_)[run_].count) {
+                ++run_;
+                offset_ = 0;
+            }
+            return *this;
+        }
+
+        const_iterator operator++(int) noexcept {
+            auto old = *this;
+            ++*this;
+            return old;
+        }
+
+        const_iterator &operator--() noexcept {
+            if (offset_ == 0) {
+                offset_ = (*runs_)[--run_].count;
+            }
+            --offset_;
+            return *this;
+        }
+
+        const_iterator operator--(int) noexcept {
+            auto old = *this;
+            --*this;
+            return old;
+        }
+
+        friend bool operator==(const const_iterator &lhs, const const_iterator &rhs) noexcept {
+            return lhs.run_ == rhs.run_ && lhs.offset_ == rhs.offset_;
+        }
+
+        friend bool operator!=(const const_iterator &lhs, const const_iterator &rhs) noexcept {
+            return !(lhs == rhs);
+        }
+
+    private:
+        friend class RunLengthSeq;
+
+        const_iterator(const std::vector<Run<T> > *runs, std::size_t run, std::uint64_t offset) noexcept
+            : runs_(runs), run_(run), offset_(offset) {}
+
+        const std::vector<Run<T> > *runs_ = nullptr;
+        std::size_t run_ = 0; // runs_->size() - the end
+        std::uint64_t offset_ = 0; // in the run
+    };
+    using iterator = const_iterator; // the elements are modified only by whole runs
+
+    RunLengthSeq() = default;
+
+    /// Compress the elements of [first, last).
+    template <typename InputIt>
+    RunLengthSeq(InputIt first, InputIt last) {
+        static_assert(std::is_base_of_v<std::input_iterator_tag, typename std::iterator_traits<InputIt>::iterator_category>);
+        for (; first != last; ++first) {
+            append(*first);
+        }
+    }
+
+    /// Append \p count elements \p value, merged into the last run if it holds the same value.
+    void append(const T &value, size_type count = 1) {
+        if (count == 0) {
+            return;
+        }
+        if (!runs_.empty() && equivalent(runs_.back().value, value)) {
+            runs_.back().count += count;
+        } else {
+            runs_.push_back({value, count});
+        }
+        size_ += count;
+    }
+
+    /// Number of elements.
+    size_type size() const noexcept {
+        return size_;
+    }
+
+    bool empty() const noexcept {
+        return size_ == 0;
+    }
+
+    /// The runs, in order.
+    const std::vector<Run<T> > &runs() const noexcept {
+        return runs_;
+    }
+
+    const_iterator begin() const noexcept {
+        return {&runs_, 0, 0};
+    }
+
+    const_iterator end() const noexcept {
+        return {&runs_, runs_.size(), 0};
+    }
+
+    /// Advance to the lexicographically next sequence of the same elements, see minGreaterSeqInPlace().
+    /**
+     * Works on the runs of the non-ascending suffix only:
+     * the suffix of runs with descending values is found by a scan from the end, the run of the smallest
+     * value greater than the pivot's by a binary search, and the suffix is reversed run by run.
+     *
+     * Complexity:
+     * - Time:  O(s) comparisons and moves of runs, s - number of runs of the non-ascending suffix
+     * - Space: O(1) (at most one run more than before)
+     *
+     * \return \c true if a greater sequence exists (now stored), \c false otherwise (unmodified)
+     */
+    bool next() {
+        const auto runCount = runs_.size();
+        auto suffix = runCount == 0 ? std::size_t{0} : runCount - 1; // first run of the non-ascending suffix
+        while (suffix != 0 && runs_[suffix].value < runs_[suffix - 1].value) {
+            --suffix;
+        }
+        if (suffix == 0) {
+            return false;
+        }
+        const auto pivot = suffix - 1; // its last element is swapped
+        // the suffix runs are descending: the last one greater than the pivot holds the swapped element
+        const auto greater = static_cast<std::size_t>(std::partition_point(runs_.begin() + static_cast<std::ptrdiff_t>(suffix), runs_.end(),
+            [&](const Run<T> &run) { return runs_[pivot].value < run.value; }) - runs_.begin()) - 1;
+        const T pivotValue = runs_[pivot].value;
+        T greaterValue = runs_[greater].value;
+
+        // move one pivot value into the suffix, in its place in the descending order
+        if (greater + 1 != runCount && equivalent(runs_[greater + 1].value, pivotValue)) {
+            ++runs_[greater + 1].count;
+        } else {
+            runs_.insert(runs_.begin() + static_cast<std::ptrdiff_t>(greater + 1), Run<T>{pivotValue, 1});
+        }
+        if (--runs_[greater].count == 0) {
+            runs_.erase(runs_.begin() + static_cast<std::ptrdiff_t>(greater));
+        }
+        std::reverse(runs_.begin() + static_cast<std::ptrdiff_t>(suffix), runs_.end()); // now ascending
+
+        // put one greater value in place of the pivot's last element;
+        // the suffix now starts with a value not greater than the pivot's, so no merge follows it
+        if (--runs_[pivot].count != 0) {
+            runs_.insert(runs_.begin() + static_cast<std::ptrdiff_t>(suffix), Run<T>{std::move(greaterValue), 1});
+        } else if (pivot != 0 && equivalent(runs_[pivot - 1].value, greaterValue)) {
+            ++runs_[pivot - 1].count;
+            runs_.erase(runs_.begin() + static_cast<std::ptrdiff_t>(pivot));
+        } else {
+            runs_[pivot] = {std::move(greaterValue), 1};
+        }
+        return true;
+    }
+
+private:
+    static bool equivalent(const T &lhs, const T &rhs) {
+        return !(lhs < rhs) && !(rhs < lhs);
+    }
+
+    std::vector<Run<T> > runs_;
+    size_type size_ = 0;
+};
+
+/// minGreaterSeqInPlace() of a run-length encoded sequence: RunLengthSeq::next().
+template <typename T>
+bool minGreaterSeqInPlace(RunLengthSeq<T> &seq) {
+    return seq.next();
+}
+
+} // namespace algos
+
+#endif // ALGORITHMS_RUN_LENGTH_SEQ_HPP_INCLUDED
@@ -0,0 +1,168 @@
+#include "GreaterNumberKernels.hpp"
+#include "RunLengthSeq.hpp"
+#include "minGreaterSeq.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <execution>
+#include <functional>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+// Benchmarks of minGreaterSeqInPlace on sequences with a long non-ascending suffix (the worst case):
+// - operator< (the vectorized path) vs a comparator vs an execution policy, on integers
+// - records ordered by a key: a comparator vs searching a separate vector of the keys
+// - few distinct values: RunLengthSeq vs a plain vector
+// - next greater number with the same digits / popcount: batch kernels vs digit strings
+// usage: ./minGreaterSeqBench [elements] [milliseconds-per-run]
+
+namespace {
+
+struct Record {
+    std::uint32_t key;
+    std::uint32_t id;
+    double weight;
+};
+
+/// Mean milliseconds per call of \p step on a fresh copy of \p start (the copy is not timed).
+template <typename T, typename Step>
+double measure(const std::vector<T> &start, std::chrono::milliseconds duration, Step step) {
+    auto seq = start;
+    std::size_t calls = 0, found = 0;
+    auto elapsed = std::chrono::steady_clock::duration{};
+    do {
+        seq = start;
+        const auto callStart = std::chrono::steady_clock::now();
+        found += step(seq);
+        elapsed += std::chrono::steady_clock::now() - callStart;
+        ++calls;
+    } while (elapsed < duration);
+    if (found != calls) {
+        std::printf("(no greater sequence found)\n");
+    }
+    return std::chrono::duration<double, std::milli>(elapsed).count() / static_cast<double>(calls);
+}
+
+/// 1 0 n-1 n-2 ... 2 as \p T: the whole sequence after the first element is scanned and reversed.
+template <typename T, typename Make>
+std::vector<T> worstCase(std::size_t size, Make make) {
+    std::vector<T> seq;
+    seq.reserve(size);
+    seq.push_back(make(1));
+    seq.push_back(make(0));
+    for (auto value = static_cast<std::uint32_t>(size - 1); seq.size() < size; --value) {
+        seq.push_back(make(value));
+    }
+    return seq;
+}
+
+void printRow(const char *name, double time, double baselineTime, const char *unit = "ms") {
+    std::printf("  %-40s %10.3f %s %8.2fx\n", name, time, unit, baselineTime / time);
+}
+
+} // anonymous namespace
+
+int main(int argc, char *argv[]) {
+    const std::size_t size = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 10'000'000;
+    const std::chrono::milliseconds duration{argc > 2 ? std::atoi(argv[2]) : 500};
+
+    std::printf("%zu elements, non-ascending suffix of %zu\n", size, size - 1);
+    const auto integers = worstCase<std::uint32_t>(size, [](std::uint32_t value) { return value; });
+    const auto baseline = measure(integers, duration, [](auto &seq) {
+        return algos::minGreaterSeqInPlace(seq.begin(), seq.end());
+    });
+    printRow("uint32_t, operator<", baseline, baseline);
+    printRow("uint32_t, comparator (lambda)", measure(integers, duration, [](auto &seq) {
+        return algos::minGreaterSeqInPlace(seq.begin(), seq.end(), [](std::uint32_t lhs, std::uint32_t rhs) {
+            return lhs < rhs;
+        });
+    }), baseline);
+    printRow("uint32_t, std::execution::par", measure(integers, duration, [](auto &seq) {
+        return algos::minGreaterSeqInPlace(std::execution::par, seq.begin(), seq.end());
+    }), baseline);
+    printRow("uint32_t, std::execution::par_unseq", measure(integers, duration, [](auto &seq) {
+        return algos::minGreaterSeqInPlace(std::execution::par_unseq, seq.begin(), seq.end());
+    }), baseline);
+
+    const auto records = worstCase<Record>(size, [](std::uint32_t value) {
+        return Record{value, value * 7, value * 0.5};
+    });
+    const auto byKey = [](const Record &lhs, const Record &rhs) { return lhs.key < rhs.key; };
+    const auto keyBaseline = measure(records, duration, [](auto &seq) {
+        // the alternative to a comparator: search a vector of the keys, then permute the records the same way
+        std::vector<std::uint32_t> keys(seq.size());
+        std::transform(seq.cbegin(), seq.cend(), keys.begin(), [](const Record &record) { return record.key; });
+        const auto before = keys;
+        if (!algos::minGreaterSeqInPlace(keys.begin(), keys.end())) {
+            return false;
+        }
+        const auto pivot = static_cast<std::size_t>(std::mismatch(keys.cbegin(), keys.cend(), before.cbegin()).first - keys.cbegin());
+        const auto greater = std::find_if(seq.rbegin(), seq.rend(), [&](const Record &record) {
+            return seq[pivot].key < record.key;
+        });
+        std::iter_swap(seq.begin() + static_cast<std::ptrdiff_t>(pivot), greater);
+        std::reverse(seq.begin() + static_cast<std::ptrdiff_t>(pivot) + 1, seq.end());
+        return true;
+    });
+    printRow("Record, key vector + operator<", keyBaseline, keyBaseline);
+    printRow("Record, comparator by key", measure(records, duration, [&](auto &seq) {
+        return algos::minGreaterSeqInPlace(seq.begin(), seq.end(), byKey);
+    }), keyBaseline);
+    printRow("Record, comparator, std::execution::par", measure(records, duration, [&](auto &seq) {
+        return algos::minGreaterSeqInPlace(std::execution::par, seq.begin(), seq.end(), byKey);
+    }), keyBaseline);
+
+    // 10 symbols, runs of size / 10: 0 1 9 8 ... 2, the whole tail is scanned and reversed
+    std::vector<std::uint8_t> symbols;
+    algos::RunLengthSeq<std::uint8_t> runs;
+    for (std::uint8_t symbol : {0, 1, 9, 8, 7, 6, 5, 4, 3, 2}) {
+        symbols.insert(symbols.end(), size / 10, symbol);
+        runs.append(symbol, size / 10);
+    }
+    const auto symbolBaseline = measure(symbols, duration, [](auto &seq) {
+        return algos::minGreaterSeqInPlace(seq.begin(), seq.end());
+    });
+    std::printf("%zu elements over 10 symbols in 10 runs\n", symbols.size());
+    printRow("uint8_t, std::vector", symbolBaseline, symbolBaseline);
+    std::vector<algos::RunLengthSeq<std::uint8_t> > runsStart{runs};
+    printRow("uint8_t, RunLengthSeq", measure(runsStart, duration, [](auto &seqs) {
+        return algos::minGreaterSeqInPlace(seqs.front());
+    }), symbolBaseline);
+
+    std::mt19937_64 random{1};
+    std::vector<std::uint64_t> numbers(size);
+    for (auto &number : numbers) {
+        number = random() >> (random() % 64);
+    }
+    std::vector<std::uint64_t> results(size);
+    std::vector<algos::NextNumberStatus> statuses(size);
+    std::printf("%zu random uint64_t values\n", size);
+    const auto perValue = [&](double ms) { return ms * 1e6 / static_cast<double>(size); };
+    const auto viaStrings = perValue(measure(numbers, duration, [&](auto &values) {
+        // the alternative to the kernel: minGreaterSeqInPlace on the decimal string
+        for (std::size_t i = 0; i < values.size(); ++i) {
+            auto digits = std::to_string(values[i]);
+            results[i] = algos::minGreaterSeqInPlace(digits.begin(), digits.end()) ? std::strtoull(digits.c_str(), nullptr, 10) : values[i];
+        }
+        return true;
+    }));
+    printRow("same digits, std::to_string + strtoull", viaStrings, viaStrings, "ns");
+    printRow("same digits, nextGreaterSameDigits", perValue(measure(numbers, duration, [&](auto &values) {
+        return algos::nextGreaterSameDigits(values.data(), values.size(), results.data(), statuses.data()) != 0;
+    })), viaStrings, "ns");
+    printRow("same digits, base 16", perValue(measure(numbers, duration, [&](auto &values) {
+        return algos::nextGreaterSameDigits(values.data(), values.size(), results.data(), statuses.data(), 16) != 0;
+    })), viaStrings, "ns");
+    const auto scalarPopcount = perValue(measure(numbers, duration, [&](auto &values) {
+        return algos::detail::nextSamePopcountScalar(values.data(), values.size(), results.data(), statuses.data()) != 0;
+    }));
+    printRow("same popcount, scalar", scalarPopcount, scalarPopcount, "ns");
+    printRow("same popcount, nextGreaterSamePopcount", perValue(measure(numbers, duration, [&](auto &values) {
+        return algos::nextGreaterSamePopcount(values.data(), values.size(), results.data(), statuses.data()) != 0;
+    })), scalarPopcount, "ns");
+    return 0;
+}
@@ -5,11 +5,19 @@
 #ifndef ALGORITHMS_MIN_GREATER_NUM_HPP_INCLUDED
 #define ALGORITHMS_MIN_GREATER_NUM_HPP_INCLUDED
 
+#include "MinGreaterSeqKernels.hpp"
 #include <algorithm>
 #include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <execution>
+#include <functional> // std::less
 #include <iterator>
+#include <memory> // std::addressof
+#include <numeric> // std::gcd
 #include <type_traits>
-#include <utility> // std::declval
+#include <utility> // std::declval, std::forward, std::pair
+#include <vector>
 
 //TODO remove this docstring from here? (duplicate)
 /// Algorithms namespace.
@@ -33,6 +41,9 @@ inline constexpr bool has_operator_less_v = has_operator_less<T>::value;
 
 } // anonymous namespace
 
+template <typename BidirIt, typename Compare>
+bool minGreaterSeqInPlace(BidirIt first, BidirIt last, Compare comp);
+
 /// Find minimum sequence greater than the given sequence using only the elements of this sequence.
 /**
  * Executes in place, modifying the input sequence.
@@ -49,6 +60,11 @@ inline constexpr bool has_operator_less_v = has_operator_less<T>::value;
  * where:
  * - n - size of the input sequence
  *
+ * Pointers and iterators of \c std::vector, \c std::basic_string and \c std::array with integer, \c float
+ * or \c double elements take a vectorized path (AVX2 when the CPU supports it): the scan for the
+ * non-ascending suffix compares 32 bytes of adjacent pairs per step and the suffix is reversed
+ * in 32-byte blocks.
+ *
  * \tparam BidirIt
  *   \parblock
  *     iterator type, must meet the requirements of
@@ -75,9 +91,7 @@ inline constexpr bool has_operator_less_v = has_operator_less<T>::value;
  * \see
  *   <a href="https://en.cppreference.com/w/cpp/algorithm/lexicographical_compare">std::lexicographical_compare</a>
  *
- * \todo add ExecutionPolicy - forward it to std::reverse, std::adjacent_find
- * \todo add second version of this algorithm: minGreaterSeqInPlace(BidirIt first, BidirIt last, Compare comp)
- *   where Compare is a <a href="https://en.cppreference.com/w/cpp/named_req/BinaryPredicate">BinaryPredicate</a>
+ * \see minGreaterSeqInPlace(BidirIt, BidirIt, Compare) for an ordering other than \c operator<
  */
 template <typename BidirIt>
 bool minGreaterSeqInPlace(BidirIt first, BidirIt last) {
@@ -89,16 +103,61 @@ bool minGreaterSeqInPlace(BidirIt first, BidirIt last) {
     static_assert(std::is_swappable_v<value_type>);
     // cannot be const_iterator
 
+    // std::less<> calls operator< (std::greater<> would need operator>)
+    return minGreaterSeqInPlace(first, last, std::less<>{});
+}
+
+namespace detail {
+
+/// Comparison the vectorized kernels implement for contiguous sequences of kernel types: \c operator<.
+template <typename BidirIt, typename Compare, typename T = typename std::iterator_traits<BidirIt>::value_type>
+inline constexpr bool is_vectorizable_v = std::conjunction_v<is_kernel_type<T>, is_contiguous_iterator<BidirIt>,
+    std::disjunction<std::is_same<Compare, std::less<> >, std::is_same<Compare, std::less<T> > > >;
+
+/// Sequences shorter than this are not worth splitting among threads.
+inline constexpr std::size_t minParallelSeqSize = std::size_t{1} << 16;
+
+} // namespace detail
+
+/// minGreaterSeqInPlace() with the elements ordered by \p comp instead of \c operator<.
+/**
+ * The sequences are compared lexicographically with \p comp comparing the elements,
+ * e.g. records by one of their fields without building a sequence of the keys.
+ * Elements equivalent under \p comp are treated as equal: the sequence found contains the same elements,
+ * but equivalent ones may trade places.
+ *
+ * \c std::less<> and \c std::less<value_type> over contiguous sequences of arithmetic types
+ * take the vectorized path of minGreaterSeqInPlace().
+ *
+ * Complexity:
+ * - Time:  O(n) calls of \p comp
+ * - Space: O(1)
+ *
+ * \tparam BidirIt same requirements as for minGreaterSeqInPlace(), except for LessThanComparable
+ * \tparam Compare
+ *   <a href="https://en.cppreference.com/w/cpp/named_req/BinaryPredicate">BinaryPredicate</a>
+ *   inducing a strict weak ordering of the elements
+ *
+ * \return same as minGreaterSeqInPlace()
+ */
+template <typename BidirIt, typename Compare>
+bool minGreaterSeqInPlace(BidirIt first, BidirIt last, Compare comp) {
+    using value_type = typename std::iterator_traits<BidirIt>::value_type;
+    static_assert(std::is_base_of_v<std::bidirectional_iterator_tag, typename std::iterator_traits<BidirIt>::iterator_category>);
+    static_assert(std::is_invocable_r_v<bool, Compare &, const value_type &, const value_type &>);
+    static_assert(std::is_swappable_v<value_type>);
+
+    if constexpr (detail::is_vectorizable_v<BidirIt, Compare>) {
+        if (first == last) {
+            return false;
+        }
+        return detail::minGreaterSeqContiguous(std::addressof(*first), static_cast<std::size_t>(last - first));
+    }
+
     auto revFirst = std::make_reverse_iterator(last);
     auto revLast = std::make_reverse_iterator(first);
-    // not using std::greater<>{} because it uses operator> instead of operator< and we only require LessThanComparable
-    //TODO try: std::bind on std::greater<>{}
-    auto revLastGreater = std::adjacent_find(revFirst, revLast, [](const auto &lhs, const auto &rhs) { // O(distance) comparisons
-        // use std::decay_t<T> as short for std::remove_cv_t<std::remove_reference_t<T> >
-        //TODO check if it makes any problems
-        static_assert(std::is_same_v<value_type, std::decay_t<decltype(lhs)> >);
-        static_assert(std::is_same_v<value_type, std::decay_t<decltype(lhs)> >);
-        return rhs < lhs;
+    auto revLastGreater = std::adjacent_find(revFirst, revLast, [&comp](const auto &lhs, const auto &rhs) { // O(distance) comparisons
+        return comp(rhs, lhs);
     });
     if (revLastGreater == revLast) {
         return false;
@@ -106,7 +165,7 @@ bool minGreaterSeqInPlace(BidirIt first, BidirIt last) {
     auto revFirstLess = std::next(revLastGreater);
 
     // the right-rest is always in non-descending order (looking from right to left)
-    auto revMinGreaterElemToRight = std::upper_bound(revFirst, revFirstLess, *revFirstLess); // O(lg(distance)) comparisons
+    auto revMinGreaterElemToRight = std::upper_bound(revFirst, revFirstLess, *revFirstLess, comp); // O(lg(distance)) comparisons
     assert(revMinGreaterElemToRight != revFirstLess);
 
     std::iter_swap(revFirstLess, revMinGreaterElemToRight); // uses ADL to find swap() for value_type
@@ -117,6 +176,289 @@ bool minGreaterSeqInPlace(BidirIt first, BidirIt last) {
     return true;
 }
 
+/// minGreaterSeqInPlace() with \p comp, with the suffix scan and the reversal run by \p policy.
+/**
+ * \p policy is forwarded to \c std::adjacent_find (the scan for the non-ascending suffix, from the end)
+ * and \c std::reverse; the binary search for the swapped element stays sequential.
+ * With \c std::execution::seq, or a sequence shorter than 64 Ki elements, it runs the sequential version
+ * (including its vectorized path).
+ *
+ * The scan of a parallel \c std::adjacent_find is not cut short by an early match, so the parallel version
+ * pays off only when the non-ascending suffix is long, e.g. for sequences near their last permutation.
+ *
+ * Complexity:
+ * - Time:  O(n / p) per thread on p threads, with random access iterators
+ * - Space: O(1) (plus what the standard library's parallel backend allocates)
+ *
+ * \tparam ExecutionPolicy one of the standard execution policies
+ * \tparam BidirIt same requirements as for minGreaterSeqInPlace(BidirIt, BidirIt, Compare); parallel standard
+ *   algorithms run sequentially unless it is a random access iterator
+ */
+template <typename ExecutionPolicy, typename BidirIt, typename Compare,
+    std::enable_if_t<std::is_execution_policy_v<std::decay_t<ExecutionPolicy> >, int> = 0>
+bool minGreaterSeqInPlace(ExecutionPolicy &&policy, BidirIt first, BidirIt last, Compare comp) {
+    using value_type = typename std::iterator_traits<BidirIt>::value_type;
+    static_assert(std::is_base_of_v<std::bidirectional_iterator_tag, typename std::iterator_traits<BidirIt>::iterator_category>);
+    static_assert(std::is_invocable_r_v<bool, Compare &, const value_type &, const value_type &>);
+    static_assert(std::is_swappable_v<value_type>);
+
+    if (std::is_same_v<std::decay_t<ExecutionPolicy>, std::execution::sequenced_policy>
+            || static_cast<std::size_t>(std::distance(first, last)) < detail::minParallelSeqSize) {
+        return minGreaterSeqInPlace(first, last, comp);
+    }
+
+    auto revFirst = std::make_reverse_iterator(last);
+    auto revLast = std::make_reverse_iterator(first);
+    auto revLastGreater = std::adjacent_find(policy, revFirst, revLast, [&comp](const auto &lhs, const auto &rhs) {
+        return comp(rhs, lhs);
+    });
+    if (revLastGreater == revLast) {
+        return false;
+    }
+    auto revFirstLess = std::next(revLastGreater);
+
+    auto revMinGreaterElemToRight = std::upper_bound(revFirst, revFirstLess, *revFirstLess, comp);
+    assert(revMinGreaterElemToRight != revFirstLess);
+
+    std::iter_swap(revFirstLess, revMinGreaterElemToRight);
+    std::reverse(policy, revFirst, revFirstLess);
+
+    return true;
+}
+
+/// minGreaterSeqInPlace() with the suffix scan and the reversal run by \p policy.
+/**
+ * \see minGreaterSeqInPlace(ExecutionPolicy &&, BidirIt, BidirIt, Compare)
+ */
+template <typename ExecutionPolicy, typename BidirIt,
+    std::enable_if_t<std::is_execution_policy_v<std::decay_t<ExecutionPolicy> >, int> = 0>
+bool minGreaterSeqInPlace(ExecutionPolicy &&policy, BidirIt first, BidirIt last) {
+    using value_type = typename std::iterator_traits<BidirIt>::value_type;
+    static_assert(has_operator_less_v<value_type>);
+    return minGreaterSeqInPlace(std::forward<ExecutionPolicy>(policy), first, last, std::less<>{});
+}
+
+namespace detail {
+
+/// Advance [first, last) to the next greater sequence, return \c false if there is none (then unmodified).
+/**
+ * minGreaterSeqInPlace() with the swapped element found by a linear search of the suffix
+ * just scanned: the steps of an enumeration cost amortized O(1).
+ */
+template <typename BidirIt>
+bool nextGreaterSeqStep(BidirIt first, BidirIt last) {
+    if (first == last) {
+        return false;
+    }
+    auto pivot = std::prev(last);
+    // the suffix after pivot is non-ascending
+    for (;;) {
+        if (pivot == first) {
+            return false;
+        }
+        auto next = pivot;
+        --pivot;
+        if (*pivot < *next) {
+            break;
+        }
+    }
+    auto greater = std::prev(last);
+    while (!(*pivot < *greater)) {
+        --greater;
+    }
+    std::iter_swap(pivot, greater);
+    std::reverse(std::next(pivot), last);
+    return true;
+}
+
+/// \p lhs * \p rhs, saturated at \c UINT64_MAX.
+constexpr std::uint64_t saturatingMultiply(std::uint64_t lhs, std::uint64_t rhs) noexcept {
+    return rhs != 0 && lhs > UINT64_MAX / rhs ? UINT64_MAX : lhs * rhs;
+}
+
+/// Binomial coefficient C(n, k), saturated at \c UINT64_MAX.
+constexpr std::uint64_t saturatingBinomial(std::uint64_t n, std::uint64_t k) noexcept {
+    k = std::min(k, n - k);
+    std::uint64_t result = 1; // C(n - k + i, i) after step i
+    for (std::uint64_t i = 1; i <= k; ++i) {
+        // result * (n - k + i) / i is exact: divide out the common factors first
+        const auto divisor = i / std::gcd(result, i);
+        result = saturatingMultiply(result / (i / divisor), (n - k + i) / divisor);
+        if (result == UINT64_MAX) {
+            return result;
+        }
+    }
+    return result;
+}
+
+/// Sorted distinct values with their numbers of occurrences.
+template <typename T>
+class Multiset {
+public:
+    void insert(const T &value) {
+        auto it = std::lower_bound(counts_.begin(), counts_.end(), value, [](const auto &entry, const T &v) {
+            return entry.first < v;
+        });
+        if (it != counts_.end() && !(value < it->first)) {
+            ++it->second;
+        } else {
+            counts_.emplace(it, value, 1);
+        }
+    }
+
+    /// Number of distinct permutations of the multiset without one occurrence of the value at \p index,
+    /// saturated at \c UINT64_MAX.
+    std::uint64_t permutationsWithout(std::size_t index) const noexcept {
+        std::uint64_t result = 1, placed = 0;
+        for (std::size_t i = 0; i < counts_.size() && result != UINT64_MAX; ++i) {
+            const auto count = counts_[i].second - (i == index);
+            placed += count;
+            // choose the positions of this value among the values placed so far
+            result = saturatingMultiply(result, saturatingBinomial(placed, count));
+        }
+        return result;
+    }
+
+    std::vector<std::pair<T, std::uint64_t> > &counts() noexcept {
+        return counts_;
+    }
+
+    const std::vector<std::pair<T, std::uint64_t> > &counts() const noexcept {
+        return counts_;
+    }
+
+private:
+    std::vector<std::pair<T, std::uint64_t> > counts_;
+};
+
+} // namespace detail
+
+/// Number of sequences greater than [first, last) using only its elements (equal sequences counted once).
+/**
+ * The number of times minGreaterSeqInPlace() returns \c true when called in a loop, saturated at \c UINT64_MAX.
+ *
+ * Complexity: O(n * d * n) time, O(d) space, where d is the number of distinct elements
+ */
+template <typename BidirIt>
+std::uint64_t greaterSeqCount(BidirIt first, BidirIt last) {
+    using value_type = typename std::iterator_traits<BidirIt>::value_type;
+    static_assert(std::is_base_of_v<std::bidirectional_iterator_tag, typename std::iterator_traits<BidirIt>::iterator_category>);
+
+    detail::Multiset<value_type> suffix;
+    std::uint64_t count = 0;
+    for (auto pos = last; pos != first && count != UINT64_MAX;) {
+        --pos;
+        suffix.insert(*pos);
+        const auto &counts = suffix.counts();
+        const auto current = static_cast<std::size_t>(std::lower_bound(counts.begin(), counts.end(), *pos,
+            [](const auto &entry, const value_type &v) { return entry.first < v; }) - counts.begin());
+        for (auto i = current + 1; i < counts.size() && count != UINT64_MAX; ++i) {
+            const auto block = suffix.permutationsWithout(i);
+            count = block > UINT64_MAX - count ? UINT64_MAX : count + block;
+        }
+    }
+    return count;
+}
+
+/// Advance the sequence by up to \p k minimum greater sequences, calling \p visit(first, last) after each one.
+/**
+ * Equivalent to calling minGreaterSeqInPlace() up to \p k times while it returns \c true,
+ * with amortized O(1) work per step when enumerating (the swapped element is found by a linear scan
+ * of the suffix already scanned instead of a binary search of reverse iterators).
+ *
+ * Complexity:
+ * - Time:  O(k) amortized over a whole enumeration, O(n) worst case per step
+ * - Space: O(1)
+ *
+ * \tparam BidirIt same requirements as for minGreaterSeqInPlace()
+ * \tparam Visitor callable as \p visit(first, last)
+ *
+ * \return number of steps made: less than \p k if the greatest sequence has been reached
+ */
+template <typename BidirIt, typename Visitor>
+std::uint64_t minGreaterSeqsInPlace(BidirIt first, BidirIt last, std::uint64_t k, Visitor visit) {
+    static_assert(std::is_base_of_v<std::bidirectional_iterator_tag, typename std::iterator_traits<BidirIt>::iterator_category>);
+
+    std::uint64_t steps = 0;
+    for (; steps < k && detail::nextGreaterSeqStep(first, last); ++steps) {
+        visit(first, last);
+    }
+    return steps;
+}
+
+/// Find the \p n-th greater sequence in lexicographic order using only the elements of this sequence.
+/**
+ * Executes in place, same as \p n calls of minGreaterSeqInPlace() but without visiting the sequences between.
+ * Duplicate elements are supported: equal sequences are counted once.
+ *
+ * Only the shortest suffix that has \p n greater arrangements changes. It is found by counting
+ * the arrangements of longer and longer suffixes (multinomial coefficients, saturated at \c UINT64_MAX),
+ * then the suffix is rewritten with the arrangement of the target rank (unranking in the mixed-radix
+ * number system of the multiset's arrangements, the factorial number system for distinct elements).
+ *
+ * Complexity:
+ * - Time:  O(s * d * s) where s is the length of the changed suffix and d the number of its distinct elements;
+ *   s is O(log n) for distinct elements
+ * - Space: O(d)
+ *
+ * \tparam BidirIt same requirements as for minGreaterSeqInPlace(); additionally the elements must be copyable
+ *
+ * \return
+ *   - \c true if the \p n-th greater sequence exists (\p n = 0 - the sequence itself)
+ *
+ *     The input sequence now contains the sequence found
+ *   - \c false otherwise
+ *
+ *     The input sequence is unmodified
+ */
+template <typename BidirIt>
+bool nthGreaterSeqInPlace(BidirIt first, BidirIt last, std::uint64_t n) {
+    using value_type = typename std::iterator_traits<BidirIt>::value_type;
+    static_assert(std::is_base_of_v<std::bidirectional_iterator_tag, typename std::iterator_traits<BidirIt>::iterator_category>);
+
+    if (n == 0) {
+        return true;
+    }
+    detail::Multiset<value_type> suffix;
+    std::uint64_t greaterInSuffix = 0; // arrangements of the suffix after pos greater than the current one
+    auto pos = last;
+    while (pos != first) {
+        --pos;
+        suffix.insert(*pos);
+        auto &counts = suffix.counts();
+        const auto current = static_cast<std::size_t>(std::lower_bound(counts.begin(), counts.end(), *pos,
+            [](const auto &entry, const value_type &v) { return entry.first < v; }) - counts.begin());
+        // arrangements starting with a greater value, in the order of the values
+        auto target = n - greaterInSuffix - 1; // rank among them, if the suffix from pos is the one to change
+        for (auto i = current + 1; i < counts.size(); ++i) {
+            const auto block = suffix.permutationsWithout(i);
+            if (target < block) {
+                // unrank: the value at pos, then the rest in the order of target
+                --counts[i].second;
+                *pos = counts[i].first;
+                for (auto out = std::next(pos); out != last; ++out) {
+                    for (std::size_t j = 0;; ++j) {
+                        if (counts[j].second == 0) {
+                            continue;
+                        }
+                        const auto arrangements = suffix.permutationsWithout(j);
+                        if (target < arrangements) {
+                            --counts[j].second;
+                            *out = counts[j].first;
+                            break;
+                        }
+                        target -= arrangements;
+                    }
+                }
+                return true;
+            }
+            target -= block;
+        }
+        greaterInSuffix = n - 1 - target; // all the greater arrangements of this suffix
+    }
+    return false;
+}
+
 } // namespace algos
 
 #endif // ALGORITHMS_MIN_GREATER_NUM_HPP_INCLUDED
@@ -0,0 +1,188 @@
+/** \file
+ * \brief Parallel enumeration of the greater sequences of a sequence.
+ */
+
+#ifndef ALGORITHMS_PARALLEL_GREATER_SEQS_HPP_INCLUDED
+#define ALGORITHMS_PARALLEL_GREATER_SEQS_HPP_INCLUDED
+
+#include "minGreaterSeq.hpp"
+#include <algorithm> // std::max, std::min
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <exception> // std::exception_ptr
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <utility> // std::declval
+#include <vector>
+
+namespace algos {
+
+namespace detail {
+
+/// Ranks [first, last) of greater sequences owned by one worker; other workers steal its upper half.
+struct alignas(64) RankRange {
+    std::mutex mutex;
+    std::uint64_t first = 0;
+    std::uint64_t last = 0;
+};
+
+/// Start of part \p part of [0, count) split into \p parts nearly equal parts, without overflow for any count.
+constexpr std::uint64_t splitPoint(std::uint64_t count, unsigned parts, unsigned part) noexcept {
+    return count / parts * part + std::min<std::uint64_t>(part, count % parts);
+}
+
+} // namespace detail
+
+/// Call \p visit(first, last) for every sequence greater than [first, last), on up to \p threadCount threads.
+/**
+ * The sequences are those minGreaterSeqInPlace() steps through in a loop; duplicate elements are supported
+ * (equal sequences are visited once). The input sequence is not modified.
+ *
+ * The greater sequences are numbered by their rank 1, 2, ..., greaterSeqCount(). Every thread starts with
+ * a contiguous interval of ranks: it jumps to the interval's first sequence by nthGreaterSeqInPlace()
+ * and steps through the rest, taking small batches off the front of its interval. A thread that runs out
+ * of work steals the upper half of the largest remaining interval, so the threads finish together even
+ * when \p visit takes uneven time.
+ *
+ * \p visit is called concurrently from several threads with [first, last) of a thread's own copy
+ * of the sequence (\c std::vector<value_type>::const_iterator). If it returns \c false (it may also
+ * return \c void), the enumeration is cancelled: no further visits start. If it throws, the enumeration
+ * is cancelled and the first exception is rethrown.
+ *
+ * Throws \c std::length_error if there are \c UINT64_MAX or more greater sequences.
+ *
+ * Complexity:
+ * - Time:  O(m / p) for m greater sequences on p threads (amortized O(1) per step, plus a jump per batch)
+ * - Space: O(n) per thread
+ *
+ * \tparam BidirIt same requirements as for nthGreaterSeqInPlace()
+ * \param threadCount number of threads, 0 - one per hardware thread
+ *
+ * \return \c true if every greater sequence was visited, \c false if the enumeration was cancelled
+ */
+template <typename BidirIt, typename Visitor>
+bool parallelForEachGreaterSeq(BidirIt first, BidirIt last, Visitor visit, unsigned threadCount = 0) {
+    using value_type = typename std::iterator_traits<BidirIt>::value_type;
+    using const_iterator = typename std::vector<value_type>::const_iterator;
+    static_assert(std::is_base_of_v<std::bidirectional_iterator_tag, typename std::iterator_traits<BidirIt>::iterator_category>);
+
+    const std::vector<value_type> start(first, last);
+    const auto count = greaterSeqCount(start.cbegin(), start.cend());
+    if (count == UINT64_MAX) {
+        throw std::length_error{"Too many greater sequences to number"};
+    }
+    if (threadCount == 0) {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+    threadCount = static_cast<unsigned>(std::max<std::uint64_t>(1, std::min<std::uint64_t>(threadCount, count)));
+
+    // ranks are 1-based: rank r is the r-th greater sequence
+    const auto ranges = std::make_unique<detail::RankRange[]>(threadCount);
+    for (unsigned t = 0; t < threadCount; ++t) {
+        ranges[t].first = 1 + detail::splitPoint(count, threadCount, t);
+        ranges[t].last = 1 + detail::splitPoint(count, threadCount, t + 1);
+    }
+
+    constexpr std::uint64_t batchSize = 1024;
+    std::atomic<bool> cancelled{false};
+    std::exception_ptr error;
+    std::mutex errorMutex;
+
+    // take the next batch of ranks of worker t: off its own interval, or stolen
+    const auto takeBatch = [&](unsigned t, std::uint64_t &batchFirst, std::uint64_t &batchLast) {
+        for (;;) {
+            {
+                std::lock_guard<std::mutex> lock{ranges[t].mutex};
+                if (ranges[t].first != ranges[t].last) {
+                    batchFirst = ranges[t].first;
+                    batchLast = std::min(ranges[t].last, batchFirst + batchSize);
+                    ranges[t].first = batchLast;
+                    return true;
+                }
+            }
+            // steal the upper half of the largest interval
+            unsigned victim = t;
+            std::uint64_t largest = 0;
+            for (unsigned v = 0; v < threadCount; ++v) {
+                std::lock_guard<std::mutex> lock{ranges[v].mutex};
+                if (ranges[v].last - ranges[v].first > largest) {
+                    largest = ranges[v].last - ranges[v].first;
+                    victim = v;
+                }
+            }
+            if (largest == 0) {
+                return false;
+            }
+            std::uint64_t stolenFirst, stolenLast;
+            {
+                std::lock_guard<std::mutex> lock{ranges[victim].mutex};
+                const auto remaining = ranges[victim].last - ranges[victim].first;
+                if (remaining == 0) {
+                    continue; // taken meanwhile: look again
+                }
+                stolenLast = ranges[victim].last;
+                stolenFirst = ranges[victim].first + remaining / 2; // a single rank is stolen whole
+                ranges[victim].last = stolenFirst;
+            }
+            std::lock_guard<std::mutex> lock{ranges[t].mutex};
+            ranges[t].first = stolenFirst;
+            ranges[t].last = stolenLast;
+        }
+    };
+
+    const auto worker = [&](unsigned t) {
+        try {
+            auto seq = start;
+            std::uint64_t rank = 0; // of seq
+            std::uint64_t batchFirst, batchLast;
+            while (!cancelled.load(std::memory_order_relaxed) && takeBatch(t, batchFirst, batchLast)) {
+                if (batchFirst < rank) { // stolen from behind: start over
+                    seq = start;
+                    rank = 0;
+                }
+                nthGreaterSeqInPlace(seq.begin(), seq.end(), batchFirst - rank);
+                for (rank = batchFirst;;) {
+                    if constexpr (std::is_same_v<decltype(visit(std::declval<const_iterator>(), std::declval<const_iterator>())), void>) {
+                        visit(seq.cbegin(), seq.cend());
+                    } else if (!visit(seq.cbegin(), seq.cend())) {
+                        cancelled = true;
+                        return;
+                    }
+                    if (rank + 1 == batchLast || cancelled.load(std::memory_order_relaxed)
+                            || !detail::nextGreaterSeqStep(seq.begin(), seq.end())) {
+                        break;
+                    }
+                    ++rank;
+                }
+            }
+        } catch (...) {
+            std::lock_guard<std::mutex> lock{errorMutex};
+            if (!error) {
+                error = std::current_exception();
+            }
+            cancelled = true;
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (unsigned t = 1; t < threadCount; ++t) {
+        threads.emplace_back(worker, t);
+    }
+    worker(0);
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+    return !cancelled;
+}
+
+} // namespace algos
+
+#endif // ALGORITHMS_PARALLEL_GREATER_SEQS_HPP_INCLUDED
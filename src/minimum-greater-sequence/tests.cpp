@@ -1,9 +1,23 @@
+#include "GreaterNumberKernels.hpp"
 #include "minGreaterSeq.hpp"
+#include "RunLengthSeq.hpp"
+#include "parallelGreaterSeqs.hpp"
+#include <algorithm>
 #include <array>
+#include <atomic>
 #include <cstdint>
+#include <execution>
+#include <functional>
 #include <forward_list>
 #include <list>
+#include <mutex>
+#include <numeric>
+#include <random>
+#include <set>
+#include <stdexcept>
 #include <string>
+#include <thread>
+#include <type_traits>
 #include <vector>
 #include <gtest/gtest.h>
 
@@ -32,6 +46,57 @@ constexpr inline bool operator==(const LessThanComparableType<T> &lhs, const Les
 
 } // namespace tests_types
 
+/// Next greater number with the same digits in \p base by minGreaterSeqInPlace() on the digit string.
+algos::NextNumberStatus referenceNextSameDigits(std::uint64_t value, unsigned base, std::uint64_t &result) {
+    std::vector<unsigned> digits; // most significant first
+    do {
+        digits.insert(digits.begin(), static_cast<unsigned>(value % base));
+        value /= base;
+    } while (value != 0);
+    if (!algos::minGreaterSeqInPlace(digits.begin(), digits.end())) {
+        return algos::NextNumberStatus::none;
+    }
+    std::uint64_t number = 0;
+    for (auto digit : digits) {
+        if (number > (UINT64_MAX - digit) / base) {
+            return algos::NextNumberStatus::overflow;
+        }
+        number = number * base + digit;
+    }
+    result = number;
+    return algos::NextNumberStatus::found;
+}
+
+/// Compare minGreaterSeqInPlace() on \p T (the vectorized path) with std::next_permutation,
+/// on sequences with long non-ascending suffixes.
+template <typename T>
+void expectSameAsNextPermutation(std::mt19937 &random, T low, T high) {
+    for (std::size_t size : {0, 1, 2, 3, 31, 32, 33, 63, 64, 65, 100, 257, 1000}) {
+        for (int round = 0; round < 20; ++round) {
+            std::vector<T> testInput(size);
+            for (auto &value : testInput) {
+                value = random() % 2 == 0 ? low : static_cast<T>(high - static_cast<T>(random() % 4));
+                if (random() % 4 == 0) {
+                    value = static_cast<T>(random() % 16);
+                }
+            }
+            const auto suffix = size == 0 ? 0 : random() % (size + 1);
+            std::sort(testInput.end() - static_cast<std::ptrdiff_t>(suffix), testInput.end(), [](T lhs, T rhs) { return rhs < lhs; });
+            auto expected = testInput;
+            const bool expectedExists = std::next_permutation(expected.begin(), expected.end());
+            if (!expectedExists) {
+                expected = testInput;
+            }
+
+            auto viaPointer = testInput;
+            EXPECT_EQ(expectedExists, algos::minGreaterSeqInPlace(viaPointer.data(), viaPointer.data() + size));
+            EXPECT_EQ(expected, viaPointer);
+            EXPECT_EQ(expectedExists, algos::minGreaterSeqInPlace(testInput.begin(), testInput.end()));
+            EXPECT_EQ(expected, testInput);
+        }
+    }
+}
+
 TEST(MinGreaterSeqInPlace, ReturnsFalseForEmptySeq) {
     std::array<int, 0> testInput {};
     auto begin = testInput.begin();
@@ -278,6 +343,397 @@ TEST(MinGreaterSeqInPlace, WorksForBidirIterator) {
     );
 }
 
+TEST(MinGreaterSeqInPlace, VectorizedPathMatchesNextPermutation) {
+    // std::basic_string is only named for character types
+    static_assert(algos::detail::is_contiguous_iterator<std::string::iterator>::value);
+    static_assert(algos::detail::is_contiguous_iterator<std::u32string::iterator>::value);
+    static_assert(algos::detail::is_contiguous_iterator<std::vector<std::uint8_t>::iterator>::value);
+    static_assert(std::is_void_v<algos::detail::string_iterator<std::int64_t>::type>);
+    static_assert(std::is_void_v<algos::detail::string_iterator<unsigned char>::type>);
+    static_assert(!algos::detail::is_contiguous_iterator<std::list<int>::iterator>::value);
+
+    std::mt19937 random{1};
+    expectSameAsNextPermutation<std::uint8_t>(random, 0, UINT8_MAX);
+    expectSameAsNextPermutation<std::int8_t>(random, INT8_MIN, INT8_MAX);
+    expectSameAsNextPermutation<std::uint16_t>(random, 0, UINT16_MAX);
+    expectSameAsNextPermutation<std::int16_t>(random, INT16_MIN, INT16_MAX);
+    expectSameAsNextPermutation<std::uint32_t>(random, 0, UINT32_MAX);
+    expectSameAsNextPermutation<std::int32_t>(random, INT32_MIN, INT32_MAX);
+    expectSameAsNextPermutation<std::uint64_t>(random, 0, UINT64_MAX);
+    expectSameAsNextPermutation<std::int64_t>(random, INT64_MIN, INT64_MAX);
+    expectSameAsNextPermutation<float>(random, -1e30f, 1e30f);
+    expectSameAsNextPermutation<double>(random, -1e300, 1e300);
+
+    std::string text = "abdcba";
+    EXPECT_TRUE(algos::minGreaterSeqInPlace(text.begin(), text.end()));
+    EXPECT_EQ("acabbd", text);
+    std::array<int, 4> array{4, 3, 2, 1};
+    EXPECT_FALSE(algos::minGreaterSeqInPlace(array.begin(), array.end()));
+    EXPECT_EQ((std::array<int, 4>{4, 3, 2, 1}), array);
+}
+
+TEST(MinGreaterSeqInPlace, OrdersByComparator) {
+    struct Record {
+        int key;
+        std::string payload;
+    };
+    std::vector<Record> records{{1, "a"}, {3, "b"}, {2, "c"}, {3, "d"}, {1, "e"}};
+    const auto byKey = [](const Record &lhs, const Record &rhs) { return lhs.key < rhs.key; };
+    std::vector<std::pair<int, std::string> > visited;
+
+    ASSERT_TRUE(algos::minGreaterSeqInPlace(records.begin(), records.end(), byKey));
+    for (const auto &record : records) {
+        visited.emplace_back(record.key, record.payload);
+    }
+    // 1 3 2 3 1 -> 1 3 3 1 2
+    EXPECT_EQ((std::vector<std::pair<int, std::string> >{{1, "a"}, {3, "b"}, {3, "d"}, {1, "e"}, {2, "c"}}), visited);
+
+    std::mt19937 random{1};
+    for (int round = 0; round < 200; ++round) {
+        std::list<int> testInput;
+        for (auto size = random() % 8; size > 0; --size) {
+            testInput.push_back(static_cast<int>(random() % 5));
+        }
+        std::vector<int> expected(testInput.begin(), testInput.end());
+        const bool exists = std::prev_permutation(expected.begin(), expected.end());
+        if (!exists) {
+            expected.assign(testInput.begin(), testInput.end());
+        }
+
+        EXPECT_EQ(exists, algos::minGreaterSeqInPlace(testInput.begin(), testInput.end(), std::greater<>{}));
+        EXPECT_EQ(expected, std::vector<int>(testInput.begin(), testInput.end()));
+    }
+}
+
+TEST(MinGreaterSeqInPlace, RunsWithExecutionPolicy) {
+    std::mt19937 random{1};
+    for (std::size_t size : {std::size_t{10}, algos::detail::minParallelSeqSize, 3 * algos::detail::minParallelSeqSize + 1}) {
+        for (std::size_t suffix : {std::size_t{0}, std::size_t{1}, size / 2, size - 1, size}) {
+            std::vector<int> testInput(size);
+            for (auto &value : testInput) {
+                value = static_cast<int>(random() % 100);
+            }
+            std::sort(testInput.end() - static_cast<std::ptrdiff_t>(suffix), testInput.end(), std::greater<>{});
+            auto expected = testInput;
+            const bool exists = std::next_permutation(expected.begin(), expected.end());
+            if (!exists) {
+                expected = testInput;
+            }
+
+            auto parallel = testInput;
+            EXPECT_EQ(exists, algos::minGreaterSeqInPlace(std::execution::par, parallel.begin(), parallel.end()));
+            EXPECT_EQ(expected, parallel);
+            auto sequenced = testInput;
+            EXPECT_EQ(exists, algos::minGreaterSeqInPlace(std::execution::seq, sequenced.begin(), sequenced.end()));
+            EXPECT_EQ(expected, sequenced);
+            auto descending = testInput;
+            auto expectedDescending = testInput;
+            const bool existsDescending = std::prev_permutation(expectedDescending.begin(), expectedDescending.end());
+            if (!existsDescending) {
+                expectedDescending = testInput;
+            }
+            EXPECT_EQ(existsDescending, algos::minGreaterSeqInPlace(std::execution::par_unseq,
+                descending.begin(), descending.end(), std::greater<>{}));
+            EXPECT_EQ(expectedDescending, descending);
+        }
+    }
+}
+
+TEST(RunLengthSeq, StepsSameAsNextPermutation) {
+    std::mt19937 random{1};
+    for (int round = 0; round < 200; ++round) {
+        std::vector<char> expected(random() % 12);
+        for (auto &value : expected) {
+            value = static_cast<char>('a' + random() % 3);
+        }
+        algos::RunLengthSeq<char> seq(expected.cbegin(), expected.cend());
+        ASSERT_EQ(expected.size(), seq.size());
+
+        for (int step = 0; step < 100; ++step) {
+            const bool exists = std::next_permutation(expected.begin(), expected.end());
+            if (!exists) {
+                std::prev_permutation(expected.begin(), expected.end()); // back to the last one
+            }
+            ASSERT_EQ(exists, algos::minGreaterSeqInPlace(seq));
+            ASSERT_EQ(expected, std::vector<char>(seq.begin(), seq.end()));
+            for (std::size_t i = 1; i < seq.runs().size(); ++i) { // normalized
+                ASSERT_NE(seq.runs()[i - 1].value, seq.runs()[i].value);
+                ASSERT_NE(0u, seq.runs()[i].count);
+            }
+            if (!exists) {
+                break;
+            }
+        }
+    }
+}
+
+TEST(RunLengthSeq, StepsLongSequencesByRuns) {
+    // 10 million elements over 10 symbols in 10 runs
+    algos::RunLengthSeq<int> seq;
+    for (int value = 0; value < 10; ++value) {
+        seq.append(value, 1'000'000);
+    }
+    EXPECT_EQ(10'000'000u, seq.size());
+    EXPECT_EQ(10u, seq.runs().size());
+
+    ASSERT_TRUE(algos::minGreaterSeqInPlace(seq)); // ... 8 (x999999) 9 8 9 (x999999)
+    ASSERT_EQ(12u, seq.runs().size());
+    EXPECT_EQ(9, seq.runs()[9].value);
+    EXPECT_EQ(1u, seq.runs()[9].count);
+    EXPECT_EQ(8, seq.runs()[10].value);
+    EXPECT_EQ(1u, seq.runs()[10].count);
+    EXPECT_EQ(999'999u, seq.runs()[11].count);
+    EXPECT_EQ(10'000'000u, static_cast<std::size_t>(std::distance(seq.begin(), seq.end())));
+
+    auto last = seq.end();
+    EXPECT_EQ(9, *--last);
+    EXPECT_EQ(9, *--last);
+    std::advance(last, -999'997); // the first element of the last run
+    EXPECT_EQ(8, *--last);
+    EXPECT_EQ(9, *--last);
+    EXPECT_EQ(8, *--last);
+}
+
+TEST(NextGreaterSameDigits, MatchesDigitPermutations) {
+    std::mt19937_64 random{1};
+    std::vector<std::uint64_t> values{0, 1, 9, 10, 12, 21, 1243, 4321, 534976, 1999999999999999999u, UINT64_MAX,
+        18446744073709551599u, 18446744073709551516u, 9876543210123456789u};
+    while (values.size() < 2000) {
+        values.push_back(random() >> (random() % 64));
+    }
+    for (unsigned base : {2u, 3u, 7u, 10u, 16u, 36u, 1000u}) {
+        std::vector<std::uint64_t> results(values.size());
+        std::vector<algos::NextNumberStatus> statuses(values.size());
+        std::size_t expectedFound = 0;
+
+        const auto found = algos::nextGreaterSameDigits(values.data(), values.size(), results.data(), statuses.data(), base);
+
+        for (std::size_t i = 0; i < values.size(); ++i) {
+            std::uint64_t expected = values[i];
+            const auto expectedStatus = referenceNextSameDigits(values[i], base, expected);
+            expectedFound += expectedStatus == algos::NextNumberStatus::found;
+            ASSERT_EQ(expectedStatus, statuses[i]) << values[i] << " in base " << base;
+            ASSERT_EQ(expected, results[i]) << values[i] << " in base " << base;
+        }
+        EXPECT_EQ(expectedFound, found);
+    }
+
+    std::vector<std::uint64_t> inPlace{1243, 4321, 18446744073709551599u};
+    std::vector<algos::NextNumberStatus> statuses(inPlace.size());
+    EXPECT_EQ(1u, algos::nextGreaterSameDigits(inPlace.data(), inPlace.size(), inPlace.data(), statuses.data()));
+    EXPECT_EQ((std::vector<std::uint64_t>{1324, 4321, 18446744073709551599u}), inPlace);
+    EXPECT_EQ((std::vector<algos::NextNumberStatus>{algos::NextNumberStatus::found, algos::NextNumberStatus::none,
+        algos::NextNumberStatus::overflow}), statuses);
+    EXPECT_THROW(algos::nextGreaterSameDigits(inPlace.data(), inPlace.size(), inPlace.data(), statuses.data(), 1),
+        std::invalid_argument);
+}
+
+TEST(NextGreaterSamePopcount, MatchesBitPermutations) {
+    std::mt19937_64 random{1};
+    std::vector<std::uint64_t> values{0, 1, 2, 3, 6, 0b10110, std::uint64_t{1} << 62, std::uint64_t{1} << 63,
+        std::uint64_t{3} << 62, std::uint64_t{5} << 61, UINT64_MAX, UINT64_MAX - 1, UINT64_MAX >> 1};
+    while (values.size() < 1003) { // not a multiple of the vector width
+        values.push_back(random() >> (random() % 64) << (random() % 64));
+    }
+    std::vector<std::uint64_t> results(values.size());
+    std::vector<algos::NextNumberStatus> statuses(values.size());
+    std::size_t expectedFound = 0;
+
+    const auto found = algos::nextGreaterSamePopcount(values.data(), values.size(), results.data(), statuses.data());
+    std::vector<std::uint64_t> scalarResults(values.size());
+    std::vector<algos::NextNumberStatus> scalarStatuses(values.size());
+    EXPECT_EQ(found, algos::detail::nextSamePopcountScalar(values.data(), values.size(), scalarResults.data(), scalarStatuses.data()));
+    EXPECT_EQ(scalarResults, results);
+    EXPECT_EQ(scalarStatuses, statuses);
+
+    for (std::size_t i = 0; i < values.size(); ++i) {
+        std::array<int, 64> bits; // most significant first
+        for (int bit = 0; bit < 64; ++bit) {
+            bits[static_cast<std::size_t>(bit)] = static_cast<int>(values[i] >> (63 - bit) & 1);
+        }
+        auto expectedStatus = algos::NextNumberStatus::found;
+        std::uint64_t expected = values[i];
+        if (!algos::minGreaterSeqInPlace(bits.begin(), bits.end())) {
+            expectedStatus = values[i] == 0 ? algos::NextNumberStatus::none : algos::NextNumberStatus::overflow;
+        } else {
+            expected = 0;
+            for (auto bit : bits) {
+                expected = expected << 1 | static_cast<std::uint64_t>(bit);
+            }
+            ++expectedFound;
+        }
+        ASSERT_EQ(expectedStatus, statuses[i]) << values[i];
+        ASSERT_EQ(expected, results[i]) << values[i];
+    }
+    EXPECT_EQ(expectedFound, found);
+}
+
+TEST(MinGreaterSeqsInPlace, VisitsSameSequencesAsNextPermutation) {
+    for (std::vector<int> testInput : {std::vector<int>{}, {1}, {1, 2, 3, 4, 5}, {1, 1, 2, 2, 3}, {3, 1, 2, 1}, {2, 2, 2}}) {
+        auto expected = testInput;
+        std::vector<std::vector<int> > visited;
+
+        const auto steps = algos::minGreaterSeqsInPlace(testInput.begin(), testInput.end(), 1000,
+            [&](auto first, auto last) { visited.emplace_back(first, last); });
+
+        ASSERT_EQ(visited.size(), steps);
+        for (const auto &seq : visited) {
+            ASSERT_TRUE(std::next_permutation(expected.begin(), expected.end()));
+            EXPECT_EQ(expected, seq);
+        }
+        EXPECT_FALSE(std::next_permutation(expected.begin(), expected.end())); // all visited
+    }
+
+    std::list<char> bidir{'a', 'b', 'c', 'd'};
+    EXPECT_EQ(5u, algos::minGreaterSeqsInPlace(bidir.begin(), bidir.end(), 5, [](auto, auto) {}));
+    EXPECT_EQ((std::list<char>{'a', 'd', 'c', 'b'}), bidir);
+}
+
+TEST(NthGreaterSeqInPlace, JumpsSameAsSteps) {
+    std::mt19937 random{1};
+    for (int round = 0; round < 300; ++round) {
+        std::vector<int> testInput(random() % 8);
+        for (auto &value : testInput) {
+            value = static_cast<int>(random() % 4);
+        }
+        std::sort(testInput.begin(), testInput.end());
+        for (int skip = random() % 50; skip > 0; --skip) {
+            std::next_permutation(testInput.begin(), testInput.end());
+        }
+        const auto n = random() % 200;
+        auto expected = testInput;
+        bool exists = true;
+        for (std::uint64_t i = 0; i < n && exists; ++i) {
+            exists = algos::minGreaterSeqInPlace(expected.begin(), expected.end());
+        }
+        const auto original = testInput;
+
+        EXPECT_EQ(exists, algos::nthGreaterSeqInPlace(testInput.begin(), testInput.end(), n));
+        EXPECT_EQ(exists ? expected : original, testInput);
+    }
+}
+
+TEST(NthGreaterSeqInPlace, JumpsFarInLongSequences) {
+    std::vector<int> testInput(40);
+    std::iota(testInput.begin(), testInput.end(), 0);
+    const std::uint64_t n = 1'000'000'000'000'000'000;
+    const auto original = testInput;
+    auto twice = testInput;
+
+    ASSERT_TRUE(algos::nthGreaterSeqInPlace(testInput.begin(), testInput.end(), n));
+    ASSERT_TRUE(algos::nthGreaterSeqInPlace(twice.begin(), twice.end(), n / 2));
+    ASSERT_TRUE(algos::nthGreaterSeqInPlace(twice.begin(), twice.end(), n / 2));
+    EXPECT_EQ(testInput, twice);
+    // 10^18 < 20! = 2.4 * 10^18: only the last 20 elements move
+    EXPECT_TRUE(std::equal(testInput.begin(), testInput.begin() + 20, original.begin()));
+    EXPECT_EQ(19, testInput[19]);
+    EXPECT_NE(20, testInput[20]);
+
+    // 21 ones, 21 twos: C(42, 21) = 538257874440 arrangements
+    std::vector<int> multiset(42, 1);
+    std::fill(multiset.begin() + 21, multiset.end(), 2);
+    auto last = multiset;
+    std::reverse(last.begin(), last.end());
+    auto copy = multiset;
+    EXPECT_FALSE(algos::nthGreaterSeqInPlace(copy.begin(), copy.end(), 538257874440));
+    EXPECT_EQ(multiset, copy);
+    EXPECT_TRUE(algos::nthGreaterSeqInPlace(copy.begin(), copy.end(), 538257874439));
+    EXPECT_EQ(last, copy);
+}
+
+TEST(GreaterSeqCount, CountsDistinctGreaterSequences) {
+    for (std::vector<int> testInput : {std::vector<int>{}, {1}, {1, 2, 3, 4, 5}, {1, 1, 2, 2, 3}, {3, 1, 2, 1}, {2, 2, 2}}) {
+        std::uint64_t expected = 0;
+        for (auto copy = testInput; std::next_permutation(copy.begin(), copy.end());) {
+            ++expected;
+        }
+        EXPECT_EQ(expected, algos::greaterSeqCount(testInput.cbegin(), testInput.cend()));
+    }
+    std::vector<int> distinct(30);
+    std::iota(distinct.begin(), distinct.end(), 0);
+    EXPECT_EQ(UINT64_MAX, algos::greaterSeqCount(distinct.cbegin(), distinct.cend())); // 30! - 1 saturates
+}
+
+TEST(ParallelForEachGreaterSeq, VisitsEveryGreaterSequenceOnce) {
+    for (std::vector<int> testInput : {std::vector<int>{}, {1}, {3, 1, 2, 1}, {1, 2, 3, 4, 5, 6, 7}, {1, 1, 2, 2, 3, 3, 4}}) {
+        std::vector<std::vector<int> > expected;
+        for (auto copy = testInput; std::next_permutation(copy.begin(), copy.end());) {
+            expected.push_back(copy);
+        }
+        for (unsigned threads : {1u, 3u, 8u}) {
+            std::mutex mutex;
+            std::vector<std::vector<int> > visited;
+
+            const bool complete = algos::parallelForEachGreaterSeq(testInput.cbegin(), testInput.cend(),
+                [&](auto first, auto last) {
+                    std::lock_guard<std::mutex> lock{mutex};
+                    visited.emplace_back(first, last);
+                }, threads);
+
+            EXPECT_TRUE(complete);
+            std::sort(visited.begin(), visited.end());
+            EXPECT_EQ(expected, visited);
+        }
+    }
+}
+
+TEST(ParallelForEachGreaterSeq, SplitsHugeCountsWithoutOverlap) {
+    // 18 distinct elements and 3 equal ones: 21! / 3! - 1 (about 2^63) greater sequences
+    std::vector<int> testInput(21);
+    std::iota(testInput.begin(), testInput.begin() + 18, 0);
+    std::fill(testInput.begin() + 18, testInput.end(), 18);
+    ASSERT_GT(algos::greaterSeqCount(testInput.cbegin(), testInput.cend()), std::uint64_t{1} << 62);
+    for (unsigned t = 0; t < 16; ++t) {
+        EXPECT_LT(algos::detail::splitPoint(UINT64_MAX - 1, 16, t), algos::detail::splitPoint(UINT64_MAX - 1, 16, t + 1));
+    }
+    EXPECT_EQ(UINT64_MAX - 1, algos::detail::splitPoint(UINT64_MAX - 1, 16, 16));
+
+    std::mutex mutex;
+    std::set<std::vector<int> > visited;
+    bool duplicate = false;
+
+    const bool complete = algos::parallelForEachGreaterSeq(testInput.cbegin(), testInput.cend(),
+        [&](auto first, auto last) {
+            std::this_thread::yield(); // interleave the threads
+            std::lock_guard<std::mutex> lock{mutex};
+            duplicate |= !visited.emplace(first, last).second;
+            return visited.size() < 2000;
+        }, 16);
+
+    EXPECT_FALSE(complete);
+    EXPECT_FALSE(duplicate);
+    EXPECT_GE(visited.size(), 2000u);
+}
+
+TEST(ParallelForEachGreaterSeq, StopsWhenCancelled) {
+    std::vector<int> testInput(10);
+    std::iota(testInput.begin(), testInput.end(), 0);
+    const std::vector<int> target{5, 3, 9, 1, 0, 2, 8, 7, 4, 6};
+    std::atomic<std::size_t> visits{0};
+    std::atomic<bool> found{false};
+
+    const bool complete = algos::parallelForEachGreaterSeq(testInput.cbegin(), testInput.cend(),
+        [&](auto first, auto last) {
+            ++visits;
+            if (std::equal(first, last, target.cbegin(), target.cend())) {
+                found = true;
+                return false;
+            }
+            return true;
+        }, 4);
+
+    EXPECT_FALSE(complete);
+    EXPECT_TRUE(found);
+    EXPECT_LT(visits.load(), 3628799u);
+
+    EXPECT_THROW(algos::parallelForEachGreaterSeq(testInput.cbegin(), testInput.cend(),
+        [](auto first, auto) {
+            if (*first == 1) {
+                throw std::runtime_error{"visitor failed"};
+            }
+        }, 2), std::runtime_error);
+}
+
 //TODO cmake's try_compile for static_asserts + check compiler error: "static assertion failed"
 // should not compile
 /*TEST(MinGreaterSeqInPlace, DoesntWorkForForwardIterator) {
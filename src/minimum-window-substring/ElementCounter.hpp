@@ -0,0 +1,341 @@
+/** \file
+ * \brief Element counters used by minWindowSubstr().
+ */
+
+#ifndef ALGORITHMS_ELEMENT_COUNTER_HPP_INCLUDED
+#define ALGORITHMS_ELEMENT_COUNTER_HPP_INCLUDED
+
+#include <algorithm> // std::fill
+#include <cstddef>
+#include <cstdint>
+#include <functional> // std::hash
+#include <limits>
+#include <type_traits>
+#include <unordered_map>
+#include <utility> // std::move, std::swap
+#include <vector>
+
+namespace algos {
+
+namespace detail {
+
+/*
+ * A counter maps the elements of a range to counts. Either every element is first declared by add(),
+ * which reports whether it is new, and after startCounting() the counts of all declared elements
+ * are zero and are accessed by operator[]; or the elements are not declared and countOf()
+ * returns the count of any element, zero for an element seen for the first time.
+ */
+
+/// Integral (except \c bool) or enumeration type.
+template <typename T>
+inline constexpr bool is_integer_like_v = (std::is_integral_v<T> && !std::is_same_v<T, bool>) || std::is_enum_v<T>;
+
+template <typename T, typename = void>
+struct integer_like_underlying {
+    using type = T;
+};
+
+template <typename T>
+struct integer_like_underlying<T, std::enable_if_t<std::is_enum_v<T> > > {
+    using type = std::underlying_type_t<T>;
+};
+
+/// Bits of \p T as an unsigned 64-bit value.
+template <typename T>
+constexpr std::uint64_t toUnsignedBits(T value) noexcept {
+    using underlying = typename integer_like_underlying<T>::type;
+    return static_cast<std::uint64_t>(static_cast<std::make_unsigned_t<underlying> >(static_cast<underlying>(value)));
+}
+
+/// Counter of any hashable type.
+template <typename T>
+class HashElementCounter {
+public:
+    bool add(const T &value) {
+        return counts_.try_emplace(value, 0).second;
+    }
+
+    void startCounting() noexcept {}
+
+    std::size_t &operator[](const T &value) {
+        return counts_.find(value)->second;
+    }
+
+    std::size_t &countOf(const T &value) {
+        return counts_[value];
+    }
+
+private:
+    std::unordered_map<T, std::size_t> counts_;
+};
+
+/// Counter of integers of at most 16 bits: a flat array indexed by the value.
+template <typename T>
+class DenseElementCounter {
+public:
+    static constexpr std::size_t domainSize = std::size_t{1} << (sizeof(T) * std::numeric_limits<unsigned char>::digits);
+
+    DenseElementCounter()
+        : counts_(domainSize, 0) {}
+
+    bool add(const T &value) {
+        auto &count = counts_[toUnsignedBits(value)];
+        const bool added = count == 0;
+        count = 1; // marks the value as declared until startCounting()
+        return added;
+    }
+
+    /// Set all counts to zero; the counter does not remember which values were declared.
+    void startCounting() noexcept {
+        std::fill(counts_.begin(), counts_.end(), 0);
+    }
+
+    std::size_t &operator[](const T &value) noexcept {
+        return counts_[toUnsignedBits(value)];
+    }
+
+    std::size_t &countOf(const T &value) noexcept {
+        return counts_[toUnsignedBits(value)];
+    }
+
+private:
+    std::vector<std::size_t> counts_;
+};
+
+/// Counter of wider integers: a flat open-addressing table with linear probing.
+template <typename T>
+class FlatElementCounter {
+public:
+    FlatElementCounter()
+        : slots_(minSlotCount) {}
+
+    bool add(const T &value) {
+        if ((size_ + 1) * maxLoadDenominator > slots_.size() * maxLoadNumerator) {
+            grow();
+        }
+        auto &slot = slots_[findSlot(value)];
+        if (slot.used) {
+            return false;
+        }
+        slot = {value, 0, true};
+        ++size_;
+        return true;
+    }
+
+    void startCounting() noexcept {}
+
+    std::size_t &operator[](const T &value) noexcept {
+        return slots_[findSlot(value)].count;
+    }
+
+    std::size_t &countOf(const T &value) {
+        if ((size_ + 1) * maxLoadDenominator > slots_.size() * maxLoadNumerator) {
+            grow();
+        }
+        auto &slot = slots_[findSlot(value)];
+        if (!slot.used) {
+            slot = {value, 0, true};
+            ++size_;
+        }
+        return slot.count;
+    }
+
+private:
+    static constexpr std::size_t minSlotCount = 16;
+    // max load factor 1/2 keeps the probe sequences short
+    static constexpr std::size_t maxLoadNumerator = 1;
+    static constexpr std::size_t maxLoadDenominator = 2;
+
+    struct Slot {
+        T value{};
+        std::size_t count = 0;
+        bool used = false;
+    };
+
+    /// Slot holding \p value, or the empty slot where it belongs.
+    std::size_t findSlot(const T &value) const noexcept {
+        const auto mask = slots_.size() - 1;
+        // Fibonacci hashing
+        auto index = static_cast<std::size_t>((toUnsignedBits(value) * 0x9E3779B97F4A7C15ULL) >> (64 - slotBits_)) & mask;
+        while (slots_[index].used && slots_[index].value != value) {
+            index = (index + 1) & mask;
+        }
+        return index;
+    }
+
+    void grow() {
+        std::vector<Slot> slots(slots_.size() * 2);
+        std::swap(slots, slots_);
+        ++slotBits_;
+        for (const auto &slot : slots) {
+            if (slot.used) {
+                slots_[findSlot(slot.value)] = slot;
+            }
+        }
+    }
+
+    std::vector<Slot> slots_;
+    unsigned slotBits_ = 4; // log2(minSlotCount)
+    std::size_t size_ = 0;
+};
+
+/*
+ * Reusable counters keep their memory between uses: reset() forgets all elements in O(1)
+ * by advancing a generation stamp, and a slot is in use only if it carries the current stamp.
+ */
+
+/// Reusable counter of integers of at most 16 bits: flat arrays indexed by the value.
+template <typename T>
+class StampedDenseElementCounter {
+public:
+    static constexpr std::size_t domainSize = DenseElementCounter<T>::domainSize;
+
+    void reset() {
+        if (counts_.empty()) {
+            counts_.resize(domainSize);
+            stamps_.resize(domainSize);
+        }
+        if (++generation_ == 0) { // the stamps wrapped around: forget them
+            std::fill(stamps_.begin(), stamps_.end(), 0);
+            generation_ = 1;
+        }
+    }
+
+    bool add(const T &value) noexcept {
+        const auto index = toUnsignedBits(value);
+        if (stamps_[index] == generation_) {
+            return false;
+        }
+        stamps_[index] = generation_;
+        counts_[index] = 0;
+        return true;
+    }
+
+    void startCounting() noexcept {}
+
+    std::size_t &operator[](const T &value) noexcept {
+        return counts_[toUnsignedBits(value)];
+    }
+
+    std::size_t memoryUsage() const noexcept {
+        return counts_.capacity() * sizeof(std::size_t) + stamps_.capacity() * sizeof(std::uint32_t);
+    }
+
+private:
+    std::vector<std::size_t> counts_;
+    std::vector<std::uint32_t> stamps_;
+    std::uint32_t generation_ = 0;
+};
+
+/// Reusable counter of any other type: a flat open-addressing table with linear probing.
+/**
+ * Integer-like values are hashed by Fibonacci hashing of their bits, other values by \c std::hash.
+ */
+template <typename T>
+class StampedFlatElementCounter {
+public:
+    StampedFlatElementCounter()
+        : slots_(minSlotCount) {}
+
+    void reset() noexcept {
+        size_ = 0;
+        if (++generation_ == 0) { // the stamps wrapped around: forget them
+            for (auto &slot : slots_) {
+                slot.stamp = 0;
+            }
+            generation_ = 1;
+        }
+    }
+
+    bool add(const T &value) {
+        if ((size_ + 1) * maxLoadDenominator > slots_.size() * maxLoadNumerator) {
+            grow();
+        }
+        auto &slot = slots_[findSlot(value)];
+        if (slot.stamp == generation_) {
+            return false;
+        }
+        slot.value = value;
+        slot.count = 0;
+        slot.stamp = generation_;
+        ++size_;
+        return true;
+    }
+
+    void startCounting() noexcept {}
+
+    std::size_t &operator[](const T &value) {
+        return slots_[findSlot(value)].count;
+    }
+
+    std::size_t memoryUsage() const noexcept {
+        return slots_.capacity() * sizeof(Slot);
+    }
+
+private:
+    static constexpr std::size_t minSlotCount = 16;
+    // max load factor 1/2 keeps the probe sequences short
+    static constexpr std::size_t maxLoadNumerator = 1;
+    static constexpr std::size_t maxLoadDenominator = 2;
+
+    struct Slot {
+        T value{};
+        std::size_t count = 0;
+        std::uint32_t stamp = 0;
+    };
+
+    static std::uint64_t bitsOf(const T &value) {
+        if constexpr (is_integer_like_v<T>) {
+            return toUnsignedBits(value);
+        } else {
+            return static_cast<std::uint64_t>(std::hash<T>{}(value));
+        }
+    }
+
+    /// Slot holding \p value, or the free slot where it belongs.
+    std::size_t findSlot(const T &value) const {
+        const auto mask = slots_.size() - 1;
+        // Fibonacci hashing
+        auto index = static_cast<std::size_t>((bitsOf(value) * 0x9E3779B97F4A7C15ULL) >> (64 - slotBits_)) & mask;
+        while (slots_[index].stamp == generation_ && !(slots_[index].value == value)) {
+            index = (index + 1) & mask;
+        }
+        return index;
+    }
+
+    void grow() {
+        std::vector<Slot> slots(slots_.size() * 2);
+        std::swap(slots, slots_);
+        ++slotBits_;
+        for (auto &slot : slots) {
+            if (slot.stamp == generation_) {
+                slots_[findSlot(slot.value)] = std::move(slot);
+            }
+        }
+    }
+
+    std::vector<Slot> slots_;
+    unsigned slotBits_ = 4; // log2(minSlotCount)
+    std::size_t size_ = 0;
+    std::uint32_t generation_ = 1;
+};
+
+/// The counter of MinWindowWorkspace for elements of type \p T.
+template <typename T>
+using ReusableElementCounter = std::conditional_t<is_integer_like_v<T> && (sizeof(T) <= 2),
+    StampedDenseElementCounter<T>, StampedFlatElementCounter<T> >;
+
+/// The counter minWindowSubstr() uses for elements of type \p T.
+template <typename T>
+using ElementCounter = std::conditional_t<!is_integer_like_v<T>, HashElementCounter<T>,
+    std::conditional_t<(sizeof(T) <= 2), DenseElementCounter<T>, FlatElementCounter<T> > >;
+
+/// Shortest range of 16-bit elements minWindowSubstr() counts in DenseElementCounter:
+/// for shorter ones clearing its 65536 counts costs more than probing FlatElementCounter.
+inline constexpr std::size_t minDenseCounterRange = std::size_t{1} << 12;
+
+} // namespace detail
+
+} // namespace algos
+
+#endif // ALGORITHMS_ELEMENT_COUNTER_HPP_INCLUDED
@@ -0,0 +1,204 @@
+/** \file
+ * \brief MinWindowIndex implementation.
+ */
+
+#ifndef ALGORITHMS_MIN_WINDOW_INDEX_HPP_INCLUDED
+#define ALGORITHMS_MIN_WINDOW_INDEX_HPP_INCLUDED
+
+#include "minWindowSubstr.hpp"
+#include <algorithm> // std::push_heap, std::pop_heap
+#include <cstddef>
+#include <functional> // std::greater
+#include <iterator>
+#include <thread>
+#include <type_traits>
+#include <unordered_map>
+#include <utility> // std::pair
+#include <vector>
+
+namespace algos {
+
+/// Index of a fixed text answering minimum window queries for any multiset of elements.
+/**
+ * A query finds the shortest window of the text containing every element of the query
+ * at least as many times as the query does, the earliest one of equally short windows
+ * (as minWindowSubstr() does).
+ *
+ * The index keeps the sorted positions of every element of the text. A query merges the position
+ * lists of its own elements only and runs the two-pointer search over the merged list,
+ * so it does not touch the rest of the text.
+ *
+ * Complexity:
+ * - Building: O(n) time, O(n) space
+ * - find(): O(q + m * log d) time, O(d + m) space
+ *
+ * where:
+ * - n - length of the text
+ * - q - size of the query
+ * - d - number of distinct elements of the query
+ * - m - number of occurrences of the query's elements in the text
+ *
+ * \note The index refers to the text it was built from: the text must outlive the index
+ *   and must not be modified.
+ *
+ * \tparam RandomIt iterator type of the text, must meet the requirements of
+ *   <a href="https://en.cppreference.com/w/cpp/named_req/RandomAccessIterator">LegacyRandomAccessIterator</a>
+ */
+template <typename RandomIt>
+class MinWindowIndex {
+    static_assert(std::is_base_of_v<std::random_access_iterator_tag, typename std::iterator_traits<RandomIt>::iterator_category>);
+
+public:
+    using value_type = typename std::iterator_traits<RandomIt>::value_type;
+    using result_type = ReturnType<RandomIt>;
+
+    /// Index the text [first, last).
+    MinWindowIndex(RandomIt first, RandomIt last)
+        : first_(first), last_(last), positions_(static_cast<std::size_t>(last - first)) {
+        const auto size = positions_.size();
+        for (std::size_t i = 0; i < size; ++i) {
+            ++lists_[first[i]].size;
+        }
+        std::size_t offset = 0;
+        for (auto &[value, list] : lists_) {
+            list.first = offset;
+            offset += list.size;
+            list.size = 0;
+        }
+        for (std::size_t i = 0; i < size; ++i) {
+            auto &list = lists_.find(first[i])->second;
+            positions_[list.first + list.size++] = i;
+        }
+    }
+
+    /// Find the shortest window containing the multiset [queryFirst, queryLast).
+    /**
+     * \return
+     *   \parblock
+     *     `tuple(window_start_iter, window_end_iter, window_length)` as minWindowSubstr() does;
+     *     `tuple(last, last, 0)` if no window contains the query or the query is empty
+     *   \endparblock
+     */
+    template <typename InputIt>
+    result_type find(InputIt queryFirst, InputIt queryLast) const {
+        // distinct query elements with the number of occurrences needed
+        struct Need {
+            const List *list;
+            std::size_t count;
+        };
+        std::vector<Need> needs;
+        std::unordered_map<value_type, std::size_t> needIndex;
+        for (; queryFirst != queryLast; ++queryFirst) {
+            const auto [it, added] = needIndex.try_emplace(*queryFirst, needs.size());
+            if (added) {
+                const auto list = lists_.find(*queryFirst);
+                if (list == lists_.end()) {
+                    return {last_, last_, 0};
+                }
+                needs.push_back({&list->second, 0});
+            }
+            ++needs[it->second].count;
+        }
+        for (const auto &need : needs) {
+            if (need.list->size < need.count) {
+                return {last_, last_, 0};
+            }
+        }
+        if (needs.empty()) {
+            return {last_, last_, 0};
+        }
+
+        // k-way merge of the position lists: (position, query element)
+        using Cursor = std::pair<std::size_t, std::size_t>;
+        std::vector<Cursor> heap;
+        std::vector<std::size_t> next(needs.size(), 1);
+        std::size_t occurrences = 0;
+        for (std::size_t i = 0; i < needs.size(); ++i) {
+            heap.emplace_back(positions_[needs[i].list->first], i);
+            occurrences += needs[i].list->size;
+        }
+        std::make_heap(heap.begin(), heap.end(), std::greater<>{});
+        std::vector<Cursor> merged;
+        merged.reserve(occurrences);
+        while (!heap.empty()) {
+            std::pop_heap(heap.begin(), heap.end(), std::greater<>{});
+            auto &cursor = heap.back();
+            merged.push_back(cursor);
+            const auto i = cursor.second;
+            if (next[i] < needs[i].list->size) {
+                cursor.first = positions_[needs[i].list->first + next[i]++];
+                std::push_heap(heap.begin(), heap.end(), std::greater<>{});
+            } else {
+                heap.pop_back();
+            }
+        }
+
+        // two pointers over the merged occurrences, as minWindowSubstr() does over the text
+        std::size_t elemsSatisfied = 0, wStart = 0, wLength = 0;
+        std::vector<std::size_t> counts(needs.size(), 0);
+        auto currStart = merged.cbegin();
+        for (auto newPos = merged.cbegin(); newPos != merged.cend(); ++newPos) {
+            if (++counts[newPos->second] == needs[newPos->second].count) {
+                ++elemsSatisfied;
+            }
+            while (elemsSatisfied == needs.size()) {
+                const auto currLength = newPos->first - currStart->first + 1;
+                if (currLength < wLength || wLength == 0) { // found shorter window
+                    wStart = currStart->first;
+                    wLength = currLength;
+                }
+                if (counts[currStart->second]-- == needs[currStart->second].count) {
+                    --elemsSatisfied;
+                }
+                ++currStart;
+            }
+        }
+        if (wLength == 0) {
+            return {last_, last_, 0};
+        }
+        const auto start = first_ + static_cast<std::ptrdiff_t>(wStart);
+        return {start, start + static_cast<std::ptrdiff_t>(wLength), wLength};
+    }
+
+    /// Run find() for every query of [queryFirst, queryLast) on up to \p threadCount threads.
+    /**
+     * A query is any range providing \c begin() and \c end().
+     *
+     * \param threadCount number of threads, 0 - one per hardware thread
+     * \return the results in the order of the queries
+     */
+    template <typename QueryIt>
+    std::vector<result_type> findAll(QueryIt queryFirst, QueryIt queryLast, unsigned threadCount = 0) const {
+        static_assert(std::is_base_of_v<std::random_access_iterator_tag, typename std::iterator_traits<QueryIt>::iterator_category>);
+        if (threadCount == 0) {
+            threadCount = std::max(1u, std::thread::hardware_concurrency());
+        }
+        std::vector<result_type> results(static_cast<std::size_t>(queryLast - queryFirst), result_type{last_, last_, 0});
+        detail::parallelFor(results.size(), threadCount, [&](std::size_t i) {
+            const auto &query = queryFirst[static_cast<std::ptrdiff_t>(i)];
+            results[i] = find(std::begin(query), std::end(query));
+        });
+        return results;
+    }
+
+    /// Length of the indexed text.
+    std::size_t size() const noexcept {
+        return positions_.size();
+    }
+
+private:
+    /// Positions of one element: positions_[first, first + size).
+    struct List {
+        std::size_t first = 0;
+        std::size_t size = 0;
+    };
+
+    RandomIt first_;
+    RandomIt last_;
+    std::unordered_map<value_type, List> lists_;
+    std::vector<std::size_t> positions_;
+};
+
+} // namespace algos
+
+#endif // ALGORITHMS_MIN_WINDOW_INDEX_HPP_INCLUDED
@@ -0,0 +1,143 @@
+/** \file
+ * \brief MinWindowTracker implementation.
+ */
+
+#ifndef ALGORITHMS_MIN_WINDOW_TRACKER_HPP_INCLUDED
+#define ALGORITHMS_MIN_WINDOW_TRACKER_HPP_INCLUDED
+
+#include "ElementCounter.hpp"
+#include "minWindowSubstr.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <utility> // std::move
+#include <vector>
+
+namespace algos {
+
+/// Online tracker of the shortest recent window containing every element type of a live stream.
+/**
+ * After every push() the current window is the shortest window ending at the last element
+ * that contains every type (distinct value) of the retained elements. By default all elements
+ * are retained; the tracker can retain only the last \p maxLength elements and/or the elements
+ * pushed within \p horizon of the last one (in the caller's time units). A type none of whose
+ * retained elements is left is forgotten.
+ *
+ * The current window contains every retained type, so an element before it never affects
+ * the result: only the current window is kept, in a ring buffer of its elements.
+ *
+ * Complexity:
+ * - Time:  amortized O(1) per push(), O(1) per current()
+ * - Space: O(w + t)
+ *
+ * where:
+ * - w - length of the longest current window
+ * - t - number of distinct types ever pushed
+ *
+ * \tparam T element type
+ */
+template <typename T>
+class MinWindowTracker {
+public:
+    /// Tracker retaining the last \p maxLength elements pushed at most \p horizon before the last one.
+    /**
+     * Throws \c std::invalid_argument if \p maxLength is 0.
+     */
+    explicit MinWindowTracker(std::size_t maxLength = SIZE_MAX, std::uint64_t horizon = UINT64_MAX)
+        : maxLength_(maxLength), horizon_(horizon) {
+        if (maxLength == 0) {
+            throw std::invalid_argument{"Maximum window length must be positive"};
+        }
+        ring_.resize(maxLength < initialCapacity ? roundUpToPowerOf2(maxLength) : initialCapacity);
+    }
+
+    /// Push the next element of the stream, happening at \p time.
+    /**
+     * Times must not decrease; they only matter if the tracker has a horizon.
+     */
+    void push(const T &value, std::uint64_t time = 0) {
+        if (size_ == ring_.size()) {
+            grow();
+        }
+        ring_[(head_ + size_++) & (ring_.size() - 1)] = {value, time};
+        if (elementCounts_.countOf(value)++ == 0) {
+            ++typeCount_;
+        }
+        ++position_;
+
+        // evict the elements out of the limits: their types may disappear
+        while (size_ > maxLength_ || time - ring_[head_].time > horizon_) {
+            if (--elementCounts_[ring_[head_].value] == 0) {
+                --typeCount_;
+            }
+            popFront();
+        }
+        // the first element of the window can go if the window still contains its type after
+        while (elementCounts_[ring_[head_].value] > 1) {
+            --elementCounts_[ring_[head_].value];
+            popFront();
+        }
+    }
+
+    /// The shortest window ending at the last element that contains every retained type.
+    /**
+     * \return `tuple(window_start_offset, window_end_offset, window_length)`, offsets from the first element
+     *   pushed; `tuple(n, n, 0)` when no element has been pushed
+     */
+    ReturnType<std::uint64_t> current() const noexcept {
+        return {position_ - size_, position_, size_};
+    }
+
+    /// Number of distinct types of the retained elements.
+    std::size_t typeCount() const noexcept {
+        return typeCount_;
+    }
+
+    /// Element \p i of the current window (0 - the first one).
+    const T &operator[](std::size_t i) const noexcept {
+        return ring_[(head_ + i) & (ring_.size() - 1)].value;
+    }
+
+private:
+    static constexpr std::size_t initialCapacity = 16;
+
+    struct Event {
+        T value;
+        std::uint64_t time;
+    };
+
+    static std::size_t roundUpToPowerOf2(std::size_t size) noexcept {
+        std::size_t capacity = 1;
+        while (capacity < size) {
+            capacity *= 2;
+        }
+        return capacity;
+    }
+
+    void popFront() noexcept {
+        head_ = (head_ + 1) & (ring_.size() - 1);
+        --size_;
+    }
+
+    void grow() {
+        std::vector<Event> ring(ring_.size() * 2);
+        for (std::size_t i = 0; i < size_; ++i) {
+            ring[i] = std::move(ring_[(head_ + i) & (ring_.size() - 1)]);
+        }
+        ring_ = std::move(ring);
+        head_ = 0;
+    }
+
+    std::size_t maxLength_;
+    std::uint64_t horizon_;
+    detail::ElementCounter<T> elementCounts_; // of the elements of the current window
+    std::size_t typeCount_ = 0;
+    std::vector<Event> ring_; // power-of-2 size
+    std::size_t head_ = 0; // first element of the current window
+    std::size_t size_ = 0;
+    std::uint64_t position_ = 0;
+};
+
+} // namespace algos
+
+#endif // ALGORITHMS_MIN_WINDOW_TRACKER_HPP_INCLUDED
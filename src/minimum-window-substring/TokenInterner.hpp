@@ -0,0 +1,231 @@
+/** \file
+ * \brief TokenInterner and minWindowSubstr() over interned tokens.
+ */
+
+#ifndef ALGORITHMS_TOKEN_INTERNER_HPP_INCLUDED
+#define ALGORITHMS_TOKEN_INTERNER_HPP_INCLUDED
+
+#include "minWindowSubstr.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <cstring> // std::memcpy
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace algos {
+
+namespace detail {
+
+/// Fast 64-bit hash of a string: 8 bytes per multiplication, then the MurmurHash3 finalizer.
+inline std::uint64_t hashToken(std::string_view token) noexcept {
+    constexpr std::uint64_t multiplier = 0x9E3779B97F4A7C15ULL;
+    const char *data = token.data();
+    auto size = token.size();
+    std::uint64_t hash = size * multiplier;
+    for (; size >= 8; data += 8, size -= 8) {
+        std::uint64_t word;
+        std::memcpy(&word, data, 8);
+        hash = (hash ^ word) * multiplier;
+        hash ^= hash >> 29;
+    }
+    if (size != 0) {
+        std::uint64_t word = 0;
+        std::memcpy(&word, data, size);
+        hash = (hash ^ word) * multiplier;
+    }
+    hash ^= hash >> 33;
+    hash *= 0xFF51AFD7ED558CCDULL;
+    hash ^= hash >> 33;
+    hash *= 0xC4CEB9FE1A85EC53ULL;
+    hash ^= hash >> 33;
+    return hash;
+}
+
+} // namespace detail
+
+/// Table mapping distinct tokens to dense 32-bit IDs 0, 1, 2, ... in the order of first interning.
+/**
+ * The table owns copies of the tokens, stored back to back in an arena of large blocks,
+ * so interning allocates only when a block fills up or the table grows. Lookups use an open-addressing
+ * table of IDs (with linear probing) and compare the stored hashes before the tokens.
+ *
+ * IDs and the views returned by token() stay valid until the interner is destroyed.
+ */
+class TokenInterner {
+public:
+    using id_type = std::uint32_t;
+
+    /// Return the ID of \p token, assign it the next one if it has not been interned yet.
+    /**
+     * Throws \c std::length_error when all 2^32 IDs are taken.
+     */
+    id_type intern(std::string_view token) {
+        const auto hash = detail::hashToken(token);
+        auto index = slotOf(hash);
+        for (; slots_[index] != emptySlot; index = (index + 1) & (slots_.size() - 1)) {
+            const auto id = slots_[index];
+            if (hashes_[id] == hash && tokens_[id] == token) {
+                return id;
+            }
+        }
+        if (tokens_.size() == emptySlot) {
+            throw std::length_error{"Too many distinct tokens"};
+        }
+        const auto id = static_cast<id_type>(tokens_.size());
+        tokens_.push_back(store(token));
+        hashes_.push_back(hash);
+        slots_[index] = id;
+        if (tokens_.size() * maxLoadDenominator > slots_.size() * maxLoadNumerator) {
+            grow();
+        }
+        return id;
+    }
+
+    /// The token with ID \p id.
+    std::string_view token(id_type id) const noexcept {
+        return tokens_[id];
+    }
+
+    /// Number of distinct tokens interned.
+    std::size_t size() const noexcept {
+        return tokens_.size();
+    }
+
+    /// Bytes of heap memory owned by the interner.
+    std::size_t memoryUsage() const noexcept {
+        return blocks_.size() * blockSize + bigTokensSize_ + slots_.capacity() * sizeof(id_type)
+            + (blocks_.capacity() + bigTokens_.capacity()) * sizeof(std::unique_ptr<char[]>)
+            + tokens_.capacity() * sizeof(std::string_view) + hashes_.capacity() * sizeof(std::uint64_t);
+    }
+
+private:
+    static constexpr id_type emptySlot = UINT32_MAX;
+    static constexpr std::size_t blockSize = std::size_t{1} << 16;
+    static constexpr std::size_t minSlotCount = 16;
+    // max load factor 1/2 keeps the probe sequences short
+    static constexpr std::size_t maxLoadNumerator = 1;
+    static constexpr std::size_t maxLoadDenominator = 2;
+
+    std::size_t slotOf(std::uint64_t hash) const noexcept {
+        return static_cast<std::size_t>(hash) & (slots_.size() - 1);
+    }
+
+    /// Copy \p token to the arena.
+    std::string_view store(std::string_view token) {
+        if (token.size() > blockSize / 4) { // would waste much of a block: an allocation of its own
+            bigTokens_.emplace_back(new char[token.size()]);
+            bigTokensSize_ += token.size();
+            std::memcpy(bigTokens_.back().get(), token.data(), token.size());
+            return {bigTokens_.back().get(), token.size()};
+        }
+        if (blocks_.empty() || blockUsed_ + token.size() > blockSize) {
+            blocks_.emplace_back(new char[blockSize]);
+            blockUsed_ = 0;
+        }
+        auto *data = blocks_.back().get() + blockUsed_;
+        if (!token.empty()) {
+            std::memcpy(data, token.data(), token.size());
+        }
+        blockUsed_ += token.size();
+        return {data, token.size()};
+    }
+
+    void grow() {
+        std::vector<id_type> slots(slots_.size() * 2, emptySlot);
+        slots_.swap(slots);
+        for (id_type id = 0; id < tokens_.size(); ++id) {
+            auto index = slotOf(hashes_[id]);
+            while (slots_[index] != emptySlot) {
+                index = (index + 1) & (slots_.size() - 1);
+            }
+            slots_[index] = id;
+        }
+    }
+
+    std::vector<std::unique_ptr<char[]> > blocks_; // the last one is being filled
+    std::size_t blockUsed_ = 0;
+    std::vector<std::unique_ptr<char[]> > bigTokens_;
+    std::size_t bigTokensSize_ = 0;
+    std::vector<id_type> slots_ = std::vector<id_type>(minSlotCount, emptySlot);
+    std::vector<std::string_view> tokens_; // by ID
+    std::vector<std::uint64_t> hashes_; // by ID
+};
+
+namespace detail {
+
+/// minWindowSubstr() of IDs less than \p idCount, counted in a flat array indexed by the ID.
+inline ReturnType<std::size_t> minWindowOfIds(const std::vector<TokenInterner::id_type> &ids, std::size_t idCount) {
+    std::vector<std::size_t> counts(idCount, 0);
+    std::size_t uniqueElems = 0, elemsPresent = 0;
+    for (auto id : ids) {
+        uniqueElems += counts[id] == 0;
+        counts[id] = 1;
+    }
+    for (auto id : ids) {
+        counts[id] = 0;
+    }
+
+    std::size_t wStart = ids.size(), wLength = 0, currStart = 0;
+    for (std::size_t newPos = 0; newPos < ids.size() && wLength != uniqueElems; ++newPos) {
+        if (++counts[ids[newPos]] == 1) {
+            ++elemsPresent;
+        }
+        while (elemsPresent == uniqueElems) {
+            const auto currLength = newPos - currStart + 1;
+            if (currLength < wLength || wLength == 0) { // found shorter window
+                wLength = currLength;
+                wStart = currStart;
+            }
+            if (--counts[ids[currStart++]] == 0) {
+                --elemsPresent;
+            }
+        }
+    }
+    return {wStart, wStart + wLength, wLength};
+}
+
+} // namespace detail
+
+/// minWindowSubstr() of a range of strings, running on interned token IDs.
+/**
+ * Every element (anything convertible to \c std::string_view, e.g. \c std::string) is interned by \p interner
+ * in one pass. The window search then runs on the IDs with a flat array of counts, so the strings
+ * are hashed once and never compared again. The result is the same as minWindowSubstr()'s.
+ *
+ * Complexity:
+ * - Time:  O(n + total length of the elements)
+ * - Space: O(n + i), i - number of tokens known to \p interner
+ *
+ * \tparam ForwardIt iterator type, must meet the requirements of
+ *   <a href="https://en.cppreference.com/w/cpp/named_req/ForwardIterator">LegacyForwardIterator</a>
+ */
+template <typename ForwardIt>
+ReturnType<ForwardIt> minWindowSubstrInterned(ForwardIt first, ForwardIt last, TokenInterner &interner) {
+    static_assert(std::is_base_of_v<std::forward_iterator_tag, typename std::iterator_traits<ForwardIt>::iterator_category>);
+
+    std::vector<TokenInterner::id_type> ids;
+    for (auto it = first; it != last; ++it) {
+        ids.push_back(interner.intern(std::string_view{*it}));
+    }
+    const auto [start, end, length] = detail::minWindowOfIds(ids, interner.size());
+    if (length == 0) {
+        return {last, last, 0};
+    }
+    const auto wStart = std::next(first, static_cast<typename std::iterator_traits<ForwardIt>::difference_type>(start));
+    return {wStart, std::next(wStart, static_cast<typename std::iterator_traits<ForwardIt>::difference_type>(length)), length};
+}
+
+/// minWindowSubstrInterned() with an interner of its own.
+template <typename ForwardIt>
+ReturnType<ForwardIt> minWindowSubstrInterned(ForwardIt first, ForwardIt last) {
+    TokenInterner interner;
+    return minWindowSubstrInterned(first, last, interner);
+}
+
+} // namespace algos
+
+#endif // ALGORITHMS_TOKEN_INTERNER_HPP_INCLUDED
@@ -0,0 +1,110 @@
+#include "minWindowSubstr.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+
+// Benchmarks of minWindowSubstr:
+// - per-call overhead on short ranges: a fresh counter per call vs a reused MinWindowWorkspace
+// usage: ./minWindowSubstrBench [milliseconds-per-run]
+
+namespace {
+
+std::atomic<std::size_t> allocationCount{0};
+
+} // anonymous namespace
+
+// count the heap allocations of the benchmarked calls
+void *operator new(std::size_t size) {
+    ++allocationCount;
+    if (void *ptr = std::malloc(size == 0 ? 1 : size)) {
+        return ptr;
+    }
+    throw std::bad_alloc{};
+}
+
+void operator delete(void *ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void *ptr, std::size_t) noexcept {
+    std::free(ptr);
+}
+
+namespace {
+
+struct Result {
+    double nsPerCall;
+    double allocationsPerCall;
+};
+
+/// Call \p search on every range of \p ranges in turn for \p duration.
+template <typename Range, typename Search>
+Result measure(const std::vector<Range> &ranges, std::chrono::milliseconds duration, Search search) {
+    for (const auto &range : ranges) { // warm-up: the workspace reaches its steady state
+        search(range);
+    }
+    std::size_t calls = 0, checksum = 0;
+    const auto allocationsBefore = allocationCount.load();
+    const auto start = std::chrono::steady_clock::now();
+    auto elapsed = std::chrono::steady_clock::duration{};
+    do {
+        for (const auto &range : ranges) {
+            checksum += std::get<2>(search(range));
+        }
+        calls += ranges.size();
+        elapsed = std::chrono::steady_clock::now() - start;
+    } while (elapsed < duration);
+    const auto allocations = allocationCount.load() - allocationsBefore;
+    if (checksum == 0) {
+        std::printf("(no window found)\n");
+    }
+    return {std::chrono::duration<double, std::nano>(elapsed).count() / static_cast<double>(calls),
+        static_cast<double>(allocations) / static_cast<double>(calls)};
+}
+
+template <typename T, typename MakeValue>
+void benchmarkWorkspace(const char *typeName, std::size_t rangeLength, std::chrono::milliseconds duration,
+        MakeValue makeValue) {
+    std::mt19937 random{1};
+    std::vector<std::vector<T> > ranges(1000);
+    for (auto &range : ranges) {
+        for (std::size_t i = 0; i < rangeLength; ++i) {
+            range.push_back(makeValue(random() % 8));
+        }
+    }
+    const auto fresh = measure(ranges, duration, [](const std::vector<T> &range) {
+        return algos::minWindowSubstr(range.cbegin(), range.cend());
+    });
+    algos::MinWindowWorkspace<T> workspace;
+    const auto reused = measure(ranges, duration, [&](const std::vector<T> &range) {
+        return algos::minWindowSubstr(range.cbegin(), range.cend(), workspace);
+    });
+    std::printf("  %-12s %6zu %14.1f %10.2f %14.1f %10.2f\n", typeName, rangeLength,
+        fresh.nsPerCall, fresh.allocationsPerCall, reused.nsPerCall, reused.allocationsPerCall);
+}
+
+} // anonymous namespace
+
+int main(int argc, char *argv[]) {
+    const std::chrono::milliseconds duration{argc > 1 ? std::atoi(argv[1]) : 200};
+
+    std::printf("Per-call overhead on short ranges of 8 unique elements\n");
+    std::printf("  %-12s %6s %14s %10s %14s %10s\n", "type", "length", "fresh ns/call", "allocs", "reused ns/call", "allocs");
+    for (std::size_t length : {16, 64, 256}) {
+        benchmarkWorkspace<char>("char", length, duration, [](unsigned value) {
+            return static_cast<char>('a' + value);
+        });
+        benchmarkWorkspace<int>("int", length, duration, [](unsigned value) {
+            return static_cast<int>(value * 1000003);
+        });
+        benchmarkWorkspace<std::string>("std::string", length, duration, [](unsigned value) {
+            return "token-" + std::to_string(value);
+        });
+    }
+    return 0;
+}
@@ -1,23 +1,314 @@
+#include "../common/MappedFile.hpp"
+#include "TokenInterner.hpp"
 #include "minWindowSubstr.hpp"
-#include <iostream>
-#include <array>
-
-//TODO interactive
-// exec-name elem-type data
-//example: ./mws d 1.1 2.2 1.1 3.3
-int main([[maybe_unused]] int argc, [[maybe_unused]] char *argv[]) {
-    std::string testInput = "abcabcabcbbaacccdab";
-    //std::string testInput = "abcb";
-    auto [wStart, wEnd, wLength] = algos::minWindowSubstr(testInput.cbegin(), testInput.cend());
-
-    std::cout << "window length: " << wLength << ", index range: [" << std::distance(testInput.cbegin(), wStart)
-        << ',' << std::distance(testInput.cbegin(), wEnd) << "], window: ";
-    for (auto it = wStart; it != wEnd; it = std::next(it)) {
-        std::cout << *it;
+#include <cerrno>
+#include <charconv>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <execution>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
+#include <vector>
+
+#include <sys/mman.h> // MADV_SEQUENTIAL
+#include <unistd.h> // read
+
+// usage:
+//   main TYPE [--binary] FILE   - elements of FILE ('-' - standard input)
+//   main TYPE --values V...     - elements given as arguments
+// example: ./main double --values 1.1 2.2 1.1 3.3
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+/// Window elements printed at most.
+constexpr std::size_t maxPrintedElements = 64;
+
+int usage(const char *program) {
+    std::fprintf(stderr,
+        "usage: %s TYPE [--binary] FILE\n"
+        "       %s TYPE --values VALUE...\n"
+        "Find the shortest window of the input containing all its unique elements.\n"
+        "TYPE: byte (b), int32 (i), int64 (l), double (d), token (t)\n"
+        "  byte  - every byte of the input is an element (the values joined by spaces)\n"
+        "  token - whitespace-separated words\n"
+        "  other - numbers separated by whitespace or commas, native binary values with --binary\n"
+        "FILE: the input file, '-' reads standard input\n",
+        program, program);
+    return 2;
+}
+
+/// The input bytes: a mapped file, standard input or the joined arguments.
+class Input {
+public:
+    explicit Input(const std::string &path) {
+        if (path == "-") {
+            readAll(STDIN_FILENO);
+            return;
+        }
+        file_ = algos::MappedFile{path};
+        file_.advise(MADV_SEQUENTIAL);
+        text_ = file_.view();
+    }
+
+    Input(char **first, char **last) {
+        for (auto arg = first; arg != last; ++arg) {
+            if (arg != first) {
+                buffer_.push_back(' ');
+            }
+            buffer_.insert(buffer_.end(), *arg, *arg + std::strlen(*arg));
+        }
+        text_ = {buffer_.data(), buffer_.size()};
+    }
+
+    std::string_view text() const noexcept {
+        return text_;
+    }
+
+private:
+    void readAll(int fd) {
+        constexpr std::size_t chunkSize = 1 << 16;
+        std::size_t size = 0;
+        for (;;) {
+            buffer_.resize(size + chunkSize);
+            const auto bytesRead = ::read(fd, buffer_.data() + size, chunkSize);
+            if (bytesRead == 0) {
+                break;
+            }
+            if (bytesRead < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                throw std::system_error{errno, std::generic_category(), "Cannot read the standard input"};
+            }
+            size += static_cast<std::size_t>(bytesRead);
+        }
+        buffer_.resize(size);
+        text_ = {buffer_.data(), buffer_.size()};
+    }
+
+    algos::MappedFile file_;
+    std::vector<char> buffer_;
+    std::string_view text_;
+};
+
+bool isSeparator(char c) noexcept {
+    return c == ' ' || c == '\n' || c == '\t' || c == '\r' || c == ',' || c == '\v' || c == '\f';
+}
+
+bool isSpace(char c) noexcept {
+    return c != ',' && isSeparator(c);
+}
+
+/// Parse the numbers of \p text with \c std::from_chars.
+/**
+ * Throws \c std::runtime_error for anything that is not a number of type \p T.
+ */
+template <typename T>
+std::vector<T> parseNumbers(std::string_view text) {
+    std::vector<T> numbers;
+    numbers.reserve(text.size() / 4);
+    const char *pos = text.data();
+    const char *const end = pos + text.size();
+    for (;;) {
+        while (pos != end && isSeparator(*pos)) {
+            ++pos;
+        }
+        if (pos == end) {
+            return numbers;
+        }
+        pos += *pos == '+' && pos + 1 != end && *(pos + 1) != '-'; // from_chars rejects the plus sign
+        T value{};
+        const auto [next, error] = std::from_chars(pos, end, value);
+        if (error != std::errc{} || (next != end && !isSeparator(*next))) {
+            const auto offset = static_cast<std::size_t>(pos - text.data());
+            throw std::runtime_error{(error == std::errc::result_out_of_range ? "Number out of range at byte "
+                : "Invalid number at byte ") + std::to_string(offset)};
+        }
+        numbers.push_back(value);
+        pos = next;
+    }
+}
+
+/// Native binary values of type \p T.
+template <typename T>
+std::vector<T> readBinary(std::string_view data) {
+    if (data.size() % sizeof(T) != 0) {
+        throw std::runtime_error{"Input size is not a multiple of the element size " + std::to_string(sizeof(T))};
+    }
+    std::vector<T> values(data.size() / sizeof(T));
+    std::memcpy(values.data(), data.data(), data.size());
+    return values;
+}
+
+/// Whitespace-separated words of \p text, referring to \p text.
+std::vector<std::string_view> tokenize(std::string_view text) {
+    std::vector<std::string_view> tokens;
+    std::size_t pos = 0;
+    for (;;) {
+        while (pos != text.size() && isSpace(text[pos])) {
+            ++pos;
+        }
+        if (pos == text.size()) {
+            return tokens;
+        }
+        const auto first = pos;
+        while (pos != text.size() && !isSpace(text[pos])) {
+            ++pos;
+        }
+        tokens.push_back(text.substr(first, pos - first));
+    }
+}
+
+/// Bits of \p value with all zeros and all NaNs the same, so equal doubles compare as equal integers.
+std::uint64_t canonicalBits(double value) noexcept {
+    if (value == 0) {
+        value = 0;
+    } else if (value != value) {
+        value = std::numeric_limits<double>::quiet_NaN();
     }
+    std::uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+double millisecondsSince(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+void printElement(unsigned char value) {
+    std::putchar(value);
+}
+
+void printElement(std::int32_t value) {
+    std::printf(" %ld", static_cast<long>(value));
+}
+
+void printElement(std::int64_t value) {
+    std::printf(" %lld", static_cast<long long>(value));
+}
+
+void printElement(double value) {
+    char buffer[32];
+    const auto result = std::to_chars(buffer, buffer + sizeof(buffer), value); // the shortest exact form
+    std::printf(" %.*s", static_cast<int>(result.ptr - buffer), buffer);
+}
+
+void printElement(std::string_view value) {
+    std::printf(" %.*s", static_cast<int>(value.size()), value.data());
+}
+
+/// Search \p elements (\p search maps them to the searched ones), print the window and the statistics.
+template <typename T, typename Search>
+void run(const T *elements, std::size_t count, std::size_t inputBytes, double loadMs, Search search) {
+    const auto start = Clock::now();
+    const auto [wStart, wEnd, wLength] = search();
+    const auto searchMs = millisecondsSince(start);
+
+    std::printf("window length: %zu, index range: [%zu,%zu), window:", wLength, wStart, wEnd);
     if (wLength == 0) {
-        std::cout << "<not found>";
+        std::printf(" <not found>");
+    } else if (wLength > maxPrintedElements) {
+        std::printf(" <%zu elements>", wLength);
+    } else {
+        if constexpr (std::is_same_v<T, unsigned char>) {
+            std::putchar(' ');
+        }
+        for (auto i = wStart; i < wEnd; ++i) {
+            printElement(elements[i]);
+        }
+    }
+    std::printf("\nelements: %zu, input: %zu bytes\n", count, inputBytes);
+    const auto seconds = searchMs / 1000;
+    std::printf("load+parse: %.3f ms, search: %.3f ms (%.1f M elements/s, %.1f MB/s)\n", loadMs, searchMs,
+        seconds > 0 ? static_cast<double>(count) / seconds / 1e6 : 0.0,
+        seconds > 0 ? static_cast<double>(inputBytes) / seconds / 1e6 : 0.0);
+}
+
+/// Parallel minWindowSubstr() of [first, last) as index offsets.
+template <typename T>
+algos::ReturnType<std::size_t> findWindow(const T *first, const T *last) {
+    const auto [wStart, wEnd, wLength] = algos::minWindowSubstr(std::execution::par, first, last);
+    return {static_cast<std::size_t>(wStart - first), static_cast<std::size_t>(wEnd - first), wLength};
+}
+
+template <typename T>
+algos::ReturnType<std::size_t> findWindow(const std::vector<T> &values) {
+    return findWindow(values.data(), values.data() + values.size());
+}
+
+template <typename T>
+void runNumbers(const Input &input, bool binary, Clock::time_point loadStart) {
+    const auto values = binary ? readBinary<T>(input.text()) : parseNumbers<T>(input.text());
+    const auto loadMs = millisecondsSince(loadStart);
+    if constexpr (std::is_floating_point_v<T>) {
+        // doubles are not integer-like: search their canonical bits with the flat integer counter
+        run(values.data(), values.size(), input.text().size(), loadMs, [&] {
+            std::vector<std::uint64_t> bits(values.size());
+            for (std::size_t i = 0; i < values.size(); ++i) {
+                bits[i] = canonicalBits(values[i]);
+            }
+            return findWindow(bits);
+        });
+    } else {
+        run(values.data(), values.size(), input.text().size(), loadMs, [&] {
+            return findWindow(values);
+        });
+    }
+}
+
+} // anonymous namespace
+
+int main(int argc, char *argv[]) {
+    if (argc < 3) {
+        return usage(argv[0]);
+    }
+    const std::string_view type = argv[1];
+    const std::string_view option = argv[2];
+    const bool binary = option == "--binary";
+    const bool values = option == "--values";
+    if ((binary && argc != 4) || (!binary && !values && argc != 3)) {
+        return usage(argv[0]);
+    }
+
+    try {
+        const auto loadStart = Clock::now();
+        const auto input = values ? Input{argv + 3, argv + argc} : Input{std::string{argv[argc - 1]}};
+        if (type == "byte" || type == "b") {
+            // searched in place, in the mapping
+            const auto *const bytes = reinterpret_cast<const unsigned char *>(input.text().data());
+            const auto size = input.text().size();
+            run(bytes, size, size, millisecondsSince(loadStart), [&] {
+                return findWindow(bytes, bytes + size);
+            });
+        } else if (type == "int32" || type == "i") {
+            runNumbers<std::int32_t>(input, binary, loadStart);
+        } else if (type == "int64" || type == "l") {
+            runNumbers<std::int64_t>(input, binary, loadStart);
+        } else if (type == "double" || type == "d") {
+            runNumbers<double>(input, binary, loadStart);
+        } else if (type == "token" || type == "t") {
+            const auto tokens = tokenize(input.text());
+            run(tokens.data(), tokens.size(), input.text().size(), millisecondsSince(loadStart), [&] {
+                // hashing every token once beats comparing strings in every step
+                const auto *const first = tokens.data();
+                const auto [wStart, wEnd, wLength] = algos::minWindowSubstrInterned(first, first + tokens.size());
+                return algos::ReturnType<std::size_t>{static_cast<std::size_t>(wStart - first),
+                    static_cast<std::size_t>(wEnd - first), wLength};
+            });
+        } else {
+            return usage(argv[0]);
+        }
+    } catch (const std::exception &e) {
+        std::fprintf(stderr, "%s: %s\n", argv[0], e.what());
+        return 1;
     }
-    std::cout << '\n';
     return 0;
 }
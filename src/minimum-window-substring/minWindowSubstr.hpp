@@ -5,10 +5,22 @@
 #ifndef ALGORITHMS_MIN_WINDOW_SUBSTR_HPP_INCLUDED
 #define ALGORITHMS_MIN_WINDOW_SUBSTR_HPP_INCLUDED
 
+#include "../common/ParallelFor.hpp"
+#include "ElementCounter.hpp"
+#include <algorithm> // std::max, std::min
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception> // std::exception_ptr
+#include <execution>
 #include <iterator>
+#include <mutex>
+#include <thread>
+#include <tuple>
 #include <type_traits>
-#include <unordered_map>
 #include <utility>
+#include <vector>
 
 /// Algorithms namespace.
 namespace algos {
@@ -20,6 +32,58 @@ namespace algos {
 template <typename Iter>
 using ReturnType = std::tuple<Iter, Iter, std::size_t>;
 
+namespace detail {
+
+/// minWindowSubstr() counting the elements with \p elementCounts (declared by add() from scratch).
+template <typename ForwardIt, typename Counter>
+ReturnType<ForwardIt> minWindowSubstr(ForwardIt first, ForwardIt last, Counter &elementCounts) {
+    std::size_t uniqueElems = 0, elemsPresent = 0;
+    // const iter vs const_iter !
+    for (/*const*/auto it = first; it != last; ++it) {
+        uniqueElems += elementCounts.add(*it);
+    }
+    elementCounts.startCounting();
+
+    ForwardIt wStart, wEnd;
+    std::size_t wLength;
+    bool initialized = false;
+    wStart = wEnd = last;
+    wLength = 0;
+
+    ForwardIt currStart = first;  // current start inclusive
+    ForwardIt newPos = currStart; // current end inclusive
+    for(; newPos != last; ++newPos) {
+        if (wLength == uniqueElems) { // found the first minimal window
+            break;
+        }
+
+        const auto count = ++elementCounts[*newPos];
+        if (count == 1) {
+            ++elemsPresent;
+        }
+        while (elemsPresent == uniqueElems) {
+            std::size_t currLength = std::distance(currStart, newPos) + 1;
+            if (currLength < wLength || !initialized) { // found shorter window
+                initialized = true;
+                wLength = currLength;
+                wStart = currStart;
+                wEnd = std::next(newPos);
+            }
+            //if (wLength == uniqueElems) // found the first minimal window
+
+            const auto count = --elementCounts[*currStart];
+            if (count == 0) {
+                --elemsPresent;
+            }
+            ++currStart;
+        }
+    }
+
+    return {wStart, wEnd, wLength};
+}
+
+} // namespace detail
+
 /// Find minimum window substring containing all unique elements of the input range.
 /**
  * Complexity:
@@ -30,6 +94,11 @@ using ReturnType = std::tuple<Iter, Iter, std::size_t>;
  * - n - size of the input range
  * - k - number of unique elements in the input range
  *
+ * Elements are counted in a flat array indexed by the value for integral and enumeration types
+ * of at most 16 bits (Space: O(2^bits) then), in a flat open-addressing table for wider integers
+ * and in a \c std::unordered_map otherwise. Random access ranges of 16-bit elements shorter than
+ * 4096 elements are counted in the flat table, which is faster to set up than the 65536 counts.
+ *
  * \tparam ForwardIt iterator type, must meet the requirements of
  *   <a href="https://en.cppreference.com/w/cpp/named_req/ForwardIterator">LegacyForwardIterator</a>
  * \param first begin iterator of the range
@@ -48,56 +117,467 @@ ReturnType<ForwardIt> minWindowSubstr(ForwardIt first, ForwardIt last) {
     // or is_convertible_v ?
 
     using value_type = typename std::iterator_traits<ForwardIt>::value_type;
-    std::unordered_map<value_type, std::size_t> elementCounts;
-    // const iter vs const_iter !
-    for (/*const*/auto it = first; it != last; ++it) {
-        elementCounts.try_emplace(*it, 0); //vs. insert({*it, 0})
+    if constexpr (detail::is_integer_like_v<value_type> && sizeof(value_type) == 2
+            && std::is_base_of_v<std::random_access_iterator_tag, typename std::iterator_traits<ForwardIt>::iterator_category>) {
+        if (static_cast<std::size_t>(last - first) < detail::minDenseCounterRange) {
+            detail::FlatElementCounter<value_type> elementCounts;
+            return detail::minWindowSubstr(first, last, elementCounts);
+        }
     }
-    std::size_t uniqueElems = elementCounts.size(), elemsPresent = 0;
+    detail::ElementCounter<value_type> elementCounts;
+    return detail::minWindowSubstr(first, last, elementCounts);
+}
 
-    ForwardIt wStart, wEnd;
-    std::size_t wLength;
-    bool initialized = false;
-    wStart = wEnd = last;
-    wLength = 0;
+/// Scratch memory of minWindowSubstr() calls, reused from call to call.
+/**
+ * The counts of the elements live in a flat table (for integers of at most 16 bits, an array indexed
+ * by the value) stamped with the generation of the call that wrote them. A call starts a new generation
+ * instead of clearing or freeing the table, so once the table has grown to the largest number
+ * of unique elements seen, the calls do not allocate at all.
+ *
+ * A workspace must not be used by concurrent calls.
+ *
+ * \tparam T element type; other than integers and enumerations, \c std::hash<T> is used
+ */
+template <typename T>
+class MinWindowWorkspace {
+public:
+    /// Bytes of heap memory owned by the workspace.
+    std::size_t memoryUsage() const noexcept {
+        return elementCounts_.memoryUsage();
+    }
 
-    ForwardIt currStart = first;  // current start inclusive
-    ForwardIt newPos = currStart; // current end inclusive
-    for(; newPos != last; ++newPos) {
-        if (wLength == uniqueElems) { // found the first minimal window
-            break;
+private:
+    template <typename ForwardIt>
+    friend ReturnType<ForwardIt> minWindowSubstr(ForwardIt first, ForwardIt last,
+        MinWindowWorkspace<typename std::iterator_traits<ForwardIt>::value_type> &workspace);
+
+    detail::ReusableElementCounter<T> elementCounts_;
+};
+
+/// minWindowSubstr() using the scratch memory of \p workspace: no allocation in steady state.
+template <typename ForwardIt>
+ReturnType<ForwardIt> minWindowSubstr(ForwardIt first, ForwardIt last,
+        MinWindowWorkspace<typename std::iterator_traits<ForwardIt>::value_type> &workspace) {
+    static_assert(std::is_base_of_v<std::forward_iterator_tag, typename std::iterator_traits<ForwardIt>::iterator_category>);
+
+    workspace.elementCounts_.reset();
+    return detail::minWindowSubstr(first, last, workspace.elementCounts_);
+}
+
+namespace detail {
+
+/// Chunks smaller than this are not worth a thread.
+inline constexpr std::size_t minParallelChunkSize = std::size_t{1} << 16;
+
+/// minWindowSubstr() of [first, last) split into \p chunkCount chunks solved on up to \p threadCount threads.
+template <typename RandomIt>
+ReturnType<RandomIt> parallelMinWindowSubstr(RandomIt first, RandomIt last, std::size_t chunkCount, unsigned threadCount) {
+    using value_type = typename std::iterator_traits<RandomIt>::value_type;
+    const auto size = static_cast<std::size_t>(last - first);
+    const auto chunkBegin = [&](std::size_t chunk) {
+        return size * chunk / chunkCount;
+    };
+
+    // 1. unique elements and their first occurrences, chunk by chunk
+    std::vector<std::vector<std::pair<value_type, std::size_t> > > chunkUniques(chunkCount);
+    parallelFor(chunkCount, threadCount, [&](std::size_t chunk) {
+        ElementCounter<value_type> seen;
+        for (auto i = chunkBegin(chunk); i < chunkBegin(chunk + 1); ++i) {
+            if (seen.add(first[i])) {
+                chunkUniques[chunk].emplace_back(first[i], i);
+            }
         }
+    });
+    std::size_t uniqueElems = 0, firstWindowEnd = 0;
+    {
+        ElementCounter<value_type> seen;
+        for (const auto &uniques : chunkUniques) {
+            for (const auto &[value, position] : uniques) {
+                if (seen.add(value)) {
+                    ++uniqueElems;
+                    firstWindowEnd = position;
+                }
+            }
+        }
+    }
 
-        const auto count = ++elementCounts.at(*newPos);
-        if (count == 1) {
-            ++elemsPresent;
+    // 2. the shortest (earliest) window ending in every chunk
+    struct Window {
+        std::size_t start = 0;
+        std::size_t length = 0; // 0 - no window ends in the chunk
+    };
+    std::vector<Window> chunkWindows(chunkCount);
+    parallelFor(chunkCount, threadCount, [&](std::size_t chunk) {
+        const auto chunkEnd = chunkBegin(chunk + 1);
+        auto end = std::max(chunkBegin(chunk), firstWindowEnd);
+        if (end >= chunkEnd) {
+            return;
         }
-        while (elemsPresent == uniqueElems) {
-            std::size_t currLength = std::distance(currStart, newPos) + 1;
-            if (currLength < wLength || !initialized) { // found shorter window
-                initialized = true;
-                wLength = currLength;
-                wStart = currStart;
-                wEnd = std::next(newPos);
+        ElementCounter<value_type> elementCounts;
+        // the shortest window ending at end: the latest start with all unique elements in [start, end]
+        std::size_t elemsPresent = 0, start = end + 1;
+        while (elemsPresent < uniqueElems) {
+            elemsPresent += ++elementCounts.countOf(first[--start]) == 1;
+        }
+        auto &best = chunkWindows[chunk];
+        best = {start, end - start + 1};
+        --elementCounts.countOf(first[start++]); // the sequential state: window shrunk past its minimum
+        --elemsPresent;
+        for (++end; end < chunkEnd && best.length != uniqueElems; ++end) {
+            if (++elementCounts.countOf(first[end]) == 1) {
+                ++elemsPresent;
             }
-            //if (wLength == uniqueElems) // found the first minimal window
+            while (elemsPresent == uniqueElems) {
+                if (end - start + 1 < best.length) {
+                    best = {start, end - start + 1};
+                }
+                if (--elementCounts.countOf(first[start++]) == 0) {
+                    --elemsPresent;
+                }
+            }
+        }
+    });
 
-            const auto count = --elementCounts.at(*currStart);
-            if (count == 0) {
-                --elemsPresent;
+    // 3. the earliest of the shortest windows
+    Window best;
+    for (const auto &window : chunkWindows) {
+        if (window.length != 0 && (best.length == 0 || window.length < best.length)) {
+            best = window;
+        }
+    }
+    if (best.length == 0) {
+        return {last, last, 0};
+    }
+    return {first + static_cast<std::ptrdiff_t>(best.start),
+        first + static_cast<std::ptrdiff_t>(best.start + best.length), best.length};
+}
+
+} // namespace detail
+
+/// Parallel minWindowSubstr(): returns exactly the window the sequential version returns.
+/**
+ * With \c std::execution::seq (or a range too small to split) it runs the sequential version.
+ * Otherwise the range is split into one chunk per hardware thread:
+ * 1. the chunks collect their unique elements in parallel; merging them in order gives the number of unique
+ *    elements and the first position \c f where a window can end (the last first occurrence)
+ * 2. every chunk solves the windows ending in it in parallel: it finds the shortest window ending at its first
+ *    end position (at least \c f) by scanning backwards, then slides the window as the sequential version does
+ * 3. the shortest window wins, the earliest one of equal windows (chunks are ordered by window end)
+ *
+ * Complexity:
+ * - Time:  O(n / p + w + k * p) per thread, where w is the length of the windows crossing chunk boundaries,
+ *   so the speedup is near-linear when the windows are much shorter than n / p
+ * - Space: O(k) per thread
+ *
+ * \tparam ExecutionPolicy one of the standard execution policies
+ * \tparam RandomIt iterator type, must meet the requirements of
+ *   <a href="https://en.cppreference.com/w/cpp/named_req/RandomAccessIterator">LegacyRandomAccessIterator</a>
+ */
+template <typename ExecutionPolicy, typename RandomIt,
+    std::enable_if_t<std::is_execution_policy_v<std::decay_t<ExecutionPolicy> >, int> = 0>
+ReturnType<RandomIt> minWindowSubstr(ExecutionPolicy &&, RandomIt first, RandomIt last) {
+    static_assert(std::is_base_of_v<std::random_access_iterator_tag, typename std::iterator_traits<RandomIt>::iterator_category>);
+
+    const unsigned threadCount = std::max(1u, std::thread::hardware_concurrency());
+    const auto chunkCount = std::min<std::size_t>(threadCount, static_cast<std::size_t>(last - first) / detail::minParallelChunkSize);
+    if (std::is_same_v<std::decay_t<ExecutionPolicy>, std::execution::sequenced_policy> || chunkCount < 2) {
+        return minWindowSubstr(first, last);
+    }
+    return detail::parallelMinWindowSubstr(first, last, chunkCount, threadCount);
+}
+
+/// Lazy range of the minimal windows of [first, last) containing all its unique elements.
+/**
+ * A window is minimal if no shorter window inside it contains all the unique elements; every window
+ * containing them contains a minimal one. The windows are produced one by one in the order of their ends
+ * (and starts) by a single pass of the two-pointer search, only those of length at most \p maxLength.
+ * The shortest windows of the whole range are the minimal windows of length get<2>(minWindowSubstr()).
+ *
+ * This is an input range: it can be iterated once, and its iterators refer to the range object.
+ *
+ * Complexity:
+ * - Time:  O(n) for the whole iteration (the unique elements are counted on construction)
+ * - Space: O(k)
+ *
+ * \tparam ForwardIt iterator type, must meet the requirements of
+ *   <a href="https://en.cppreference.com/w/cpp/named_req/ForwardIterator">LegacyForwardIterator</a>
+ */
+template <typename ForwardIt>
+class MinimalWindows {
+    static_assert(std::is_base_of_v<std::forward_iterator_tag, typename std::iterator_traits<ForwardIt>::iterator_category>);
+
+public:
+    class iterator {
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = ReturnType<ForwardIt>;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const value_type *;
+        using reference = const value_type &;
+
+        iterator() = default;
+
+        reference operator*() const noexcept {
+            return windows_->window_;
+        }
+
+        pointer operator->() const noexcept {
+            return &windows_->window_;
+        }
+
+        iterator &operator++() {
+            if (!windows_->next()) {
+                windows_ = nullptr;
             }
-            ++currStart;
+            return *this;
+        }
+
+        void operator++(int) {
+            ++*this;
         }
+
+        friend bool operator==(const iterator &lhs, const iterator &rhs) noexcept {
+            return lhs.windows_ == rhs.windows_;
+        }
+
+        friend bool operator!=(const iterator &lhs, const iterator &rhs) noexcept {
+            return !(lhs == rhs);
+        }
+
+    private:
+        friend class MinimalWindows;
+
+        explicit iterator(MinimalWindows *windows) noexcept
+            : windows_(windows) {}
+
+        MinimalWindows *windows_ = nullptr; // nullptr - the end
+    };
+
+    /// Minimal windows of [first, last) of length at most \p maxLength.
+    MinimalWindows(ForwardIt first, ForwardIt last, std::size_t maxLength = SIZE_MAX)
+        : currStart_(first), newPos_(first), last_(last), maxLength_(maxLength), window_{last, last, 0} {
+        for (auto it = first; it != last; ++it) {
+            uniqueElems_ += elementCounts_.add(*it);
+        }
+        elementCounts_.startCounting();
     }
 
-    return {wStart, wEnd, wLength};
+    /// Iterator to the current window: the first one, found on the first call only.
+    /**
+     * Later calls do not advance the search, they return the window the iteration has reached
+     * (the end after the last window).
+     */
+    iterator begin() {
+        if (!started_) {
+            started_ = true;
+            next();
+        }
+        return iterator{hasWindow_ ? this : nullptr};
+    }
+
+    iterator end() noexcept {
+        return iterator{};
+    }
+
+private:
+    /// Move to the next minimal window, return \c false if there is none.
+    bool next() {
+        hasWindow_ = advance();
+        return hasWindow_;
+    }
+
+    /// Find the next minimal window, return \c false if there is none.
+    bool advance() {
+        while (newPos_ != last_) {
+            const auto count = ++elementCounts_[*newPos_];
+            ++newPos_;
+            ++newIndex_;
+            if (count != 1 || ++elemsPresent_ != uniqueElems_) {
+                continue;
+            }
+            // [currStart_, newPos_) contains every element: shrink it while it still does
+            while (elementCounts_[*currStart_] > 1) {
+                --elementCounts_[*currStart_];
+                ++currStart_;
+                ++startIndex_;
+            }
+            const auto length = newIndex_ - startIndex_;
+            const auto windowStart = currStart_;
+            --elementCounts_[*currStart_];
+            --elemsPresent_;
+            ++currStart_;
+            ++startIndex_;
+            if (length <= maxLength_) {
+                window_ = {windowStart, newPos_, length};
+                return true;
+            }
+        }
+        return false;
+    }
+
+    detail::ElementCounter<typename std::iterator_traits<ForwardIt>::value_type> elementCounts_;
+    std::size_t uniqueElems_ = 0;
+    std::size_t elemsPresent_ = 0;
+    ForwardIt currStart_; // current start inclusive
+    ForwardIt newPos_; // current end exclusive
+    ForwardIt last_;
+    std::size_t startIndex_ = 0; // of currStart_
+    std::size_t newIndex_ = 0; // of newPos_
+    std::size_t maxLength_;
+    ReturnType<ForwardIt> window_;
+    bool started_ = false; // begin() has found the first window
+    bool hasWindow_ = false; // window_ is a minimal window, not past the last one
+};
+
+/// Minimal windows of [first, last) of length at most \p maxLength, see MinimalWindows.
+template <typename ForwardIt>
+MinimalWindows<ForwardIt> minimalWindows(ForwardIt first, ForwardIt last, std::size_t maxLength = SIZE_MAX) {
+    return {first, last, maxLength};
 }
 
-//TODO lastMinWindowSubstr()
-// easy way: reverse iterator
+/// All the shortest windows of [first, last) containing all its unique elements, in order.
+/**
+ * The windows minWindowSubstr() chooses from: the first of them is the result of minWindowSubstr(),
+ * the last one the result of lastMinWindowSubstr().
+ *
+ * Complexity: O(n) time for the whole iteration, O(k) space
+ */
+template <typename ForwardIt>
+MinimalWindows<ForwardIt> allMinWindowSubstr(ForwardIt first, ForwardIt last) {
+    return {first, last, std::get<2>(minWindowSubstr(first, last))};
+}
+
+/// Find the last of the shortest windows containing all unique elements of the input range.
+/**
+ * Same as minWindowSubstr() except for the tie-break: the window that starts last is returned.
+ *
+ * Complexity:
+ * - Time:  O(n)
+ * - Space: O(k)
+ *
+ * \tparam ForwardIt iterator type, must meet the requirements of
+ *   <a href="https://en.cppreference.com/w/cpp/named_req/ForwardIterator">LegacyForwardIterator</a>
+ */
+template <typename ForwardIt>
+ReturnType<ForwardIt> lastMinWindowSubstr(ForwardIt first, ForwardIt last) {
+    ReturnType<ForwardIt> result{last, last, 0};
+    for (const auto &window : minimalWindows(first, last)) {
+        if (std::get<2>(window) <= std::get<2>(result) || std::get<2>(result) == 0) {
+            result = window;
+        }
+    }
+    return result;
+}
+
+/// Single-pass minWindowSubstr() over a stream of elements fed in chunks.
+/**
+ * Finds the set of unique elements incrementally: the current window always ends at the last element
+ * pushed and starts at the latest position such that it contains every element seen so far.
+ * An element seen for the first time invalidates all windows found before.
+ *
+ * Complexity:
+ * - Time:  O(n)
+ * - Space: O(k + w)
+ *
+ * where:
+ * - n - number of elements pushed
+ * - k - number of unique elements
+ * - w - length of the current window (only the window is buffered)
+ *
+ * \tparam T element type
+ */
+template <typename T>
+class MinWindowSubstrStream {
+public:
+    /// Push the next element of the stream.
+    void push(const T &value) {
+        auto &count = elementCounts_.countOf(value);
+        if (count++ == 0) { // never seen - every window found so far lacks it
+            initialized_ = false;
+        }
+        window_.push_back(value);
+        // the first element of the window can go if the window still contains it after
+        for (;;) {
+            auto &frontCount = elementCounts_[window_.front()];
+            if (frontCount == 1) {
+                break;
+            }
+            --frontCount;
+            window_.pop_front();
+            ++windowStart_;
+        }
+        ++position_;
+        if (window_.size() < wLength_ || !initialized_) { // found shorter window
+            initialized_ = true;
+            wLength_ = window_.size();
+            wStart_ = windowStart_;
+        }
+    }
+
+    /// Push the elements of the chunk [first, last).
+    template <typename InputIt>
+    void push(InputIt first, InputIt last) {
+        for (; first != last; ++first) {
+            push(*first);
+        }
+    }
 
-//TODO minWindowSubstrNoPreproc()
-// without first iteration over all elements to put in the map
+    /// Minimum window of the elements pushed so far.
+    /**
+     * \return `tuple(window_start_offset, window_end_offset, window_length)`, offsets from the first element
+     *   pushed; `tuple(n, n, 0)` when no element has been pushed
+     */
+    ReturnType<std::uint64_t> result() const {
+        if (!initialized_) {
+            return {position_, position_, 0};
+        }
+        return {wStart_, wStart_ + wLength_, wLength_};
+    }
+
+private:
+    detail::ElementCounter<T> elementCounts_;
+    std::deque<T> window_;
+    std::uint64_t windowStart_ = 0;
+    std::uint64_t position_ = 0;
+    std::uint64_t wStart_ = 0;
+    std::size_t wLength_ = 0;
+    bool initialized_ = false;
+};
+
+/// minWindowSubstr() reading the input range once; works with input iterators.
+/**
+ * See MinWindowSubstrStream for the complexity.
+ *
+ * \tparam InputIt iterator type, must meet the requirements of
+ *   <a href="https://en.cppreference.com/w/cpp/named_req/InputIterator">LegacyInputIterator</a>
+ *
+ * \return `tuple(window_start_offset, window_end_offset, window_length)` - the same window as minWindowSubstr()
+ *   returns, as offsets from \p first
+ */
+template <typename InputIt>
+ReturnType<std::uint64_t> minWindowSubstrNoPreproc(InputIt first, InputIt last) {
+    static_assert(std::is_base_of_v<std::input_iterator_tag, typename std::iterator_traits<InputIt>::iterator_category>);
+    MinWindowSubstrStream<typename std::iterator_traits<InputIt>::value_type> stream;
+    stream.push(first, last);
+    return stream.result();
+}
+
+/// minWindowSubstr() of a stream read in chunks of up to \p chunkSize elements by \p reader.
+/**
+ * \p reader(T *buffer, std::size_t capacity) fills \p buffer with at most \p capacity elements
+ * and returns their number, 0 at the end of the stream. Lets files larger than memory be processed
+ * in a single sequential read, e.g. with a reader calling POSIX \c read().
+ */
+template <typename T, typename Reader>
+ReturnType<std::uint64_t> minWindowSubstrNoPreproc(Reader reader, std::size_t chunkSize = 1 << 16) {
+    MinWindowSubstrStream<T> stream;
+    std::vector<T> buffer(chunkSize);
+    for (std::size_t count; (count = reader(buffer.data(), buffer.size())) != 0;) {
+        stream.push(buffer.cbegin(), buffer.cbegin() + static_cast<std::ptrdiff_t>(count));
+    }
+    return stream.result();
+}
 
 } // namespace algos
 
@@ -1,5 +1,18 @@
+#include "MinWindowIndex.hpp"
+#include "MinWindowTracker.hpp"
+#include "TokenInterner.hpp"
 #include "minWindowSubstr.hpp"
 #include <array>
+#include <algorithm>
+#include <cstdint>
+#include <execution>
+#include <iterator>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <tuple>
 #include <vector>
 #include <gtest/gtest.h>
 
@@ -73,6 +86,440 @@ TEST(MinWindowSubstr, FindsLastSubstrWhenUsingReverseIterator) {
     );
 }
 
+TEST(MinWindowSubstr, CountsEveryElementType) {
+    const auto check = [](const auto &input, std::size_t start, std::size_t length) {
+        auto [wStart, wEnd, wLength] = algos::minWindowSubstr(input.cbegin(), input.cend());
+        EXPECT_EQ(start, static_cast<std::size_t>(std::distance(input.cbegin(), wStart)));
+        EXPECT_EQ(length, static_cast<std::size_t>(std::distance(wStart, wEnd)));
+        EXPECT_EQ(length, wLength);
+    };
+    // flat array counters, including negative values
+    check(std::vector<signed char>{-1, 5, -1, -128, 127, 5, -1}, 1, 4);
+    check(std::vector<std::int16_t>{-300, 7, 7, 32767, -300, -32768, 7}, 2, 4);
+    // flat open-addressing counters
+    check(std::vector<std::int64_t>{1ll << 40, -1, 1ll << 40, 3, -1, 1ll << 40}, 1, 3);
+    check(std::vector<std::uint32_t>{7, 7, 7}, 0, 1);
+    enum class Color : std::uint64_t { red = 1ull << 63, green = 2, blue = 3 };
+    check(std::vector<Color>{Color::red, Color::red, Color::green, Color::blue, Color::red}, 1, 3);
+    // hash map counters
+    check(std::vector<bool>{true, true, false}, 1, 2);
+    check(std::vector<std::string>{"a", "bb", "a", "a", "c", "bb"}, 3, 3);
+}
+
+TEST(MinWindowSubstr, FlatCountersGrowWithManyUniqueElements) {
+    std::vector<int> input;
+    for (int i = 0; i < 5000; ++i) {
+        input.push_back(i * 7919);
+    }
+    input.insert(input.begin(), input.begin() + 10, input.begin() + 20); // a longer prefix, same set
+
+    auto [wStart, wEnd, wLength] = algos::minWindowSubstr(input.cbegin(), input.cend());
+
+    EXPECT_EQ(std::next(input.cbegin(), 10), wStart);
+    EXPECT_EQ(input.cend(), wEnd);
+    EXPECT_EQ(5000, wLength);
+}
+
+TEST(MinWindowSubstr, Counts16BitElementsOfShortAndLongRanges) {
+    std::mt19937 random{5};
+    // below and above the shortest range counted in the flat array
+    for (std::size_t size : {std::size_t{100}, algos::detail::minDenseCounterRange - 1,
+            algos::detail::minDenseCounterRange, std::size_t{20000}}) {
+        std::vector<std::uint16_t> input(size);
+        for (auto &value : input) {
+            value = static_cast<std::uint16_t>(random() % 300 * 199);
+        }
+        const std::vector<int> wide(input.cbegin(), input.cend()); // counted in the flat table
+
+        const auto [wStart, wEnd, wLength] = algos::minWindowSubstr(input.cbegin(), input.cend());
+        const auto [expectedStart, expectedEnd, expectedLength] = algos::minWindowSubstr(wide.cbegin(), wide.cend());
+        EXPECT_EQ(expectedStart - wide.cbegin(), wStart - input.cbegin()) << size;
+        EXPECT_EQ(expectedEnd - wide.cbegin(), wEnd - input.cbegin()) << size;
+        EXPECT_EQ(expectedLength, wLength) << size;
+    }
+}
+
+TEST(MinWindowSubstr, FindsLastSubstr) {
+    const std::array<unsigned short, 8> testInput{1, 1, 2, 1, 3, 1, 2, 3};
+
+    auto [wStart, wEnd, wLength] = algos::lastMinWindowSubstr(testInput.cbegin(), testInput.cend());
+
+    EXPECT_EQ(std::next(testInput.cbegin(), 5), wStart);
+    EXPECT_EQ(testInput.cend(), wEnd);
+    EXPECT_EQ(3, wLength);
+}
+
+TEST(MinimalWindows, EnumeratesMinimalWindowsLazily) {
+    const std::string input = "abcabcbbaacccdab";
+    std::vector<std::string> windows;
+    for (const auto &[wStart, wEnd, wLength] : algos::minimalWindows(input.cbegin(), input.cend())) {
+        windows.emplace_back(wStart, wEnd);
+        EXPECT_EQ(windows.back().size(), wLength);
+    }
+    EXPECT_EQ((std::vector<std::string>{"baacccd", "cdab"}), windows);
+
+    windows.clear();
+    const std::string periodic = "abcabcbbaac";
+    for (const auto &[wStart, wEnd, wLength] : algos::minimalWindows(periodic.cbegin(), periodic.cend(), 3)) {
+        windows.emplace_back(wStart, wEnd);
+    }
+    EXPECT_EQ((std::vector<std::string>{"abc", "bca", "cab", "abc"}), windows); // not cbba, baac
+
+    const std::string empty;
+    auto none = algos::minimalWindows(empty.cbegin(), empty.cend());
+    EXPECT_EQ(none.end(), none.begin());
+}
+
+TEST(MinimalWindows, BeginDoesNotSkipWindows) {
+    const std::string periodic = "abcabcbbaac";
+    auto windows = algos::minimalWindows(periodic.cbegin(), periodic.cend(), 3);
+    auto first = windows.begin();
+    auto again = windows.begin();
+    ASSERT_NE(windows.end(), again);
+    EXPECT_EQ(first, again);
+    EXPECT_EQ("abc", std::string(std::get<0>(*again), std::get<1>(*again)));
+    ++again;
+    EXPECT_EQ("bca", std::string(std::get<0>(*windows.begin()), std::get<1>(*windows.begin()))); // the current one
+    std::size_t rest = 0;
+    for (auto it = windows.begin(); it != windows.end(); ++it) {
+        ++rest;
+    }
+    EXPECT_EQ(3u, rest); // bca, cab, abc
+    EXPECT_EQ(windows.end(), windows.begin());
+}
+
+TEST(MinimalWindows, EnumeratesSameWindowsAsBruteForce) {
+    std::mt19937 random{11};
+    for (int round = 0; round < 300; ++round) {
+        std::vector<int> input(random() % 40);
+        const auto alphabet = 1 + random() % 5;
+        for (auto &value : input) {
+            value = static_cast<int>(random() % alphabet);
+        }
+        std::vector<int> distinct = input;
+        std::sort(distinct.begin(), distinct.end());
+        distinct.erase(std::unique(distinct.begin(), distinct.end()), distinct.end());
+        const auto containsAll = [&](auto start, auto end) {
+            std::vector<int> window(start, end);
+            std::sort(window.begin(), window.end());
+            window.erase(std::unique(window.begin(), window.end()), window.end());
+            return window == distinct;
+        };
+        // minimal: contains all, and neither of the two windows one shorter does
+        std::vector<algos::ReturnType<std::vector<int>::const_iterator> > expected;
+        for (auto start = input.cbegin(); start != input.cend(); ++start) {
+            for (auto end = start + 1; end <= input.cend(); ++end) {
+                if (containsAll(start, end) && !containsAll(start + 1, end) && !containsAll(start, end - 1)) {
+                    expected.emplace_back(start, end, static_cast<std::size_t>(end - start));
+                }
+            }
+        }
+        std::sort(expected.begin(), expected.end(), [](const auto &lhs, const auto &rhs) {
+            return std::get<1>(lhs) < std::get<1>(rhs);
+        });
+        auto windows = algos::minimalWindows(input.cbegin(), input.cend());
+        const std::vector<algos::ReturnType<std::vector<int>::const_iterator> > actual(windows.begin(), windows.end());
+        EXPECT_EQ(expected, actual);
+
+        auto shortest = algos::allMinWindowSubstr(input.cbegin(), input.cend());
+        const std::vector<algos::ReturnType<std::vector<int>::const_iterator> > all(shortest.begin(), shortest.end());
+        const auto first = algos::minWindowSubstr(input.cbegin(), input.cend());
+        const auto last = algos::lastMinWindowSubstr(input.cbegin(), input.cend());
+        if (input.empty()) {
+            EXPECT_TRUE(all.empty());
+            EXPECT_EQ(first, last);
+            continue;
+        }
+        ASSERT_FALSE(all.empty());
+        EXPECT_EQ(first, all.front());
+        EXPECT_EQ(last, all.back());
+        for (const auto &window : all) {
+            EXPECT_EQ(std::get<2>(first), std::get<2>(window));
+        }
+        // the last one is the first one of the reversed range
+        const auto [rStart, rEnd, rLength] = algos::minWindowSubstr(input.crbegin(), input.crend());
+        EXPECT_EQ(std::get<0>(last), rEnd.base());
+        EXPECT_EQ(std::get<1>(last), rStart.base());
+        EXPECT_EQ(std::get<2>(last), rLength);
+    }
+}
+
+TEST(MinWindowSubstr, ReusesWorkspace) {
+    std::mt19937 random{19};
+    algos::MinWindowWorkspace<char> chars;
+    algos::MinWindowWorkspace<long> longs;
+    algos::MinWindowWorkspace<std::string> strings;
+    for (int round = 0; round < 300; ++round) {
+        // short and long ranges alternate: the tables grow, then are reused
+        std::vector<long> input(round % 10 == 0 ? 2000 : random() % 30);
+        const auto alphabet = round % 10 == 0 ? 500 : 1 + random() % 6;
+        for (auto &value : input) {
+            value = static_cast<long>(random() % alphabet) * 1000003;
+        }
+        const std::string text(input.begin(), input.end());
+        std::vector<std::string> words;
+        for (auto value : input) {
+            words.push_back(std::to_string(value));
+        }
+
+        EXPECT_EQ(algos::minWindowSubstr(input.cbegin(), input.cend()), algos::minWindowSubstr(input.cbegin(), input.cend(), longs));
+        EXPECT_EQ(algos::minWindowSubstr(text.cbegin(), text.cend()), algos::minWindowSubstr(text.cbegin(), text.cend(), chars));
+        EXPECT_EQ(algos::minWindowSubstr(words.cbegin(), words.cend()), algos::minWindowSubstr(words.cbegin(), words.cend(), strings));
+    }
+    EXPECT_LT(0u, strings.memoryUsage());
+}
+
+TEST(MinWindowSubstrNoPreproc, FindsSameWindowAsMinWindowSubstr) {
+    std::mt19937 random{3};
+    for (int round = 0; round < 300; ++round) {
+        std::vector<int> input(random() % 40);
+        const auto alphabet = 1 + random() % 6;
+        for (auto &value : input) {
+            value = static_cast<int>(random() % alphabet);
+        }
+        auto [wStart, wEnd, wLength] = algos::minWindowSubstr(input.cbegin(), input.cend());
+        auto [start, end, length] = algos::minWindowSubstrNoPreproc(input.cbegin(), input.cend());
+
+        EXPECT_EQ(static_cast<std::uint64_t>(std::distance(input.cbegin(), wStart)), start);
+        EXPECT_EQ(static_cast<std::uint64_t>(std::distance(input.cbegin(), wEnd)), end);
+        EXPECT_EQ(wLength, length);
+    }
+}
+
+TEST(MinWindowSubstrNoPreproc, WorksOnInputIterators) {
+    std::istringstream input{"abdbaadcbca"}; // result: adcb [5-8(inclusive)]
+
+    auto [start, end, length] = algos::minWindowSubstrNoPreproc(
+        std::istreambuf_iterator<char>{input}, std::istreambuf_iterator<char>{});
+
+    EXPECT_EQ(5u, start);
+    EXPECT_EQ(9u, end);
+    EXPECT_EQ(4u, length);
+}
+
+TEST(MinWindowSubstrNoPreproc, ReadsChunks) {
+    const std::string input = "abdbaadcbcaxyzzyxabdc"; // result: zyxabdc [14-20(inclusive)]
+    std::size_t position = 0;
+    const auto reader = [&](char *buffer, std::size_t capacity) {
+        const auto count = std::min(capacity, input.size() - position);
+        std::copy_n(input.begin() + static_cast<std::ptrdiff_t>(position), count, buffer);
+        position += count;
+        return count;
+    };
+
+    auto [start, end, length] = algos::minWindowSubstrNoPreproc<char>(reader, 4);
+
+    EXPECT_EQ(14u, start);
+    EXPECT_EQ(21u, end);
+    EXPECT_EQ(7u, length);
+
+    algos::MinWindowSubstrStream<char> stream;
+    EXPECT_EQ(std::make_tuple(std::uint64_t{0}, std::uint64_t{0}, std::size_t{0}), stream.result());
+    stream.push(input.begin(), input.begin() + 10);
+    stream.push(input[10]);
+    EXPECT_EQ(std::make_tuple(std::uint64_t{5}, std::uint64_t{9}, std::size_t{4}), stream.result());
+}
+
+TEST(MinWindowSubstrParallel, FindsSameWindowAsMinWindowSubstr) {
+    std::mt19937 random{5};
+    const auto check = [](const auto &input) {
+        const auto expected = algos::minWindowSubstr(input.cbegin(), input.cend());
+
+        EXPECT_EQ(expected, algos::minWindowSubstr(std::execution::par, input.cbegin(), input.cend()));
+        // the split must not matter, whatever the number of hardware threads
+        for (std::size_t chunkCount : {2, 3, 8, 61}) {
+            EXPECT_EQ(expected, algos::detail::parallelMinWindowSubstr(input.cbegin(), input.cend(), chunkCount, 4));
+        }
+    };
+    for (std::size_t size : {std::size_t{0}, std::size_t{1}, std::size_t{50}, std::size_t{1000}, std::size_t{1} << 17}) {
+        for (unsigned alphabet : {1u, 3u, 50u, 3000u}) {
+            std::vector<int> input(size);
+            for (auto &value : input) {
+                value = static_cast<int>(random() % alphabet);
+            }
+            check(input);
+            if (size != 0) { // rare elements make long windows crossing chunk boundaries
+                input[random() % size] = -1;
+                input[random() % size] = -2;
+                check(input);
+            }
+        }
+    }
+    // equally short windows in every chunk: the first one wins
+    std::string periodic;
+    while (periodic.size() < (std::size_t{1} << 17)) {
+        periodic += "aabbccabc";
+    }
+    check(periodic);
+}
+
+TEST(MinWindowIndex, FindsShortestWindowContainingQuery) {
+    const std::string text = "adobecodebanc";
+    const algos::MinWindowIndex index{text.cbegin(), text.cend()};
+
+    const std::string query = "abc";
+    auto [wStart, wEnd, wLength] = index.find(query.cbegin(), query.cend());
+    EXPECT_EQ("banc", std::string(wStart, wEnd));
+    EXPECT_EQ(4, wLength);
+
+    const std::string repeated = "odd";
+    std::tie(wStart, wEnd, wLength) = index.find(repeated.cbegin(), repeated.cend());
+    EXPECT_EQ("dobecod", std::string(wStart, wEnd));
+
+    for (const std::string missing : {"x", "aaa", ""}) {
+        EXPECT_EQ(std::make_tuple(text.cend(), text.cend(), std::size_t{0}), index.find(missing.cbegin(), missing.cend()));
+    }
+}
+
+TEST(MinWindowIndex, FindsSameWindowAsBruteForce) {
+    std::mt19937 random{7};
+    for (int round = 0; round < 100; ++round) {
+        std::vector<int> text(1 + random() % 60);
+        for (auto &value : text) {
+            value = static_cast<int>(random() % 5);
+        }
+        const algos::MinWindowIndex index{text.cbegin(), text.cend()};
+        // the query of all distinct elements is what minWindowSubstr() solves
+        std::vector<int> distinct = text;
+        std::sort(distinct.begin(), distinct.end());
+        distinct.erase(std::unique(distinct.begin(), distinct.end()), distinct.end());
+        EXPECT_EQ(algos::minWindowSubstr(text.cbegin(), text.cend()), index.find(distinct.cbegin(), distinct.cend()));
+
+        std::vector<std::vector<int> > queries(20);
+        for (auto &query : queries) {
+            query.resize(1 + random() % 6);
+            for (auto &value : query) {
+                value = static_cast<int>(random() % 6);
+            }
+        }
+        const auto results = index.findAll(queries.cbegin(), queries.cend(), 3);
+        ASSERT_EQ(queries.size(), results.size());
+        for (std::size_t q = 0; q < queries.size(); ++q) {
+            auto needed = queries[q];
+            std::sort(needed.begin(), needed.end());
+            // the earliest-ending shortest window
+            auto expected = std::make_tuple(text.cend(), text.cend(), std::size_t{0});
+            for (auto end = text.cbegin() + 1; end <= text.cend(); ++end) {
+                for (auto start = end - 1;; --start) {
+                    std::vector<int> window(start, end);
+                    std::sort(window.begin(), window.end());
+                    if (std::includes(window.begin(), window.end(), needed.begin(), needed.end())) {
+                        const auto length = static_cast<std::size_t>(end - start);
+                        if (std::get<2>(expected) == 0 || length < std::get<2>(expected)) {
+                            expected = std::make_tuple(start, end, length);
+                        }
+                        break;
+                    }
+                    if (start == text.cbegin()) {
+                        break;
+                    }
+                }
+            }
+            EXPECT_EQ(expected, results[q]);
+        }
+    }
+}
+
+TEST(MinWindowTracker, TracksShortestRecentWindow) {
+    algos::MinWindowTracker<char> tracker;
+    EXPECT_EQ(std::make_tuple(std::uint64_t{0}, std::uint64_t{0}, std::size_t{0}), tracker.current());
+    for (char c : std::string{"abcabcbb"}) {
+        tracker.push(c);
+    }
+    EXPECT_EQ(std::make_tuple(std::uint64_t{3}, std::uint64_t{8}, std::size_t{5}), tracker.current()); // "abcbb"
+    EXPECT_EQ(3u, tracker.typeCount());
+    EXPECT_EQ('a', tracker[0]);
+
+    algos::MinWindowTracker<char> lastThree{3};
+    for (char c : std::string{"abcdd"}) {
+        lastThree.push(c);
+    }
+    EXPECT_EQ(std::make_tuple(std::uint64_t{2}, std::uint64_t{5}, std::size_t{3}), lastThree.current()); // "cdd"
+    EXPECT_EQ(2u, lastThree.typeCount());
+
+    algos::MinWindowTracker<int> recent{SIZE_MAX, 10};
+    recent.push(1, 0);
+    recent.push(2, 5);
+    recent.push(2, 11); // 1 is out of the horizon
+    EXPECT_EQ(std::make_tuple(std::uint64_t{2}, std::uint64_t{3}, std::size_t{1}), recent.current());
+
+    EXPECT_THROW(algos::MinWindowTracker<int>{0}, std::invalid_argument);
+}
+
+TEST(MinWindowTracker, FindsSameWindowAsRecomputation) {
+    std::mt19937 random{13};
+    for (int round = 0; round < 50; ++round) {
+        const std::size_t maxLength = round % 3 == 0 ? SIZE_MAX : 1 + random() % 20;
+        const std::uint64_t horizon = round % 2 == 0 ? UINT64_MAX : random() % 30;
+        const auto alphabet = 1 + random() % 6;
+        algos::MinWindowTracker<int> tracker{maxLength, horizon};
+        std::vector<int> values;
+        std::vector<std::uint64_t> times;
+        for (int i = 0; i < 200; ++i) {
+            values.push_back(static_cast<int>(random() % alphabet));
+            times.push_back((times.empty() ? 0 : times.back()) + random() % 4);
+            tracker.push(values.back(), times.back());
+
+            // the retained elements, then the shortest suffix containing all their types
+            auto first = values.size() - std::min(values.size(), maxLength);
+            while (times.back() - times[first] > horizon) {
+                ++first;
+            }
+            std::vector<int> types(values.begin() + static_cast<std::ptrdiff_t>(first), values.end());
+            std::sort(types.begin(), types.end());
+            types.erase(std::unique(types.begin(), types.end()), types.end());
+            auto start = values.size();
+            for (std::vector<int> seen; seen.size() != types.size();) {
+                --start;
+                if (std::find(seen.begin(), seen.end(), values[start]) == seen.end()) {
+                    seen.push_back(values[start]);
+                }
+            }
+            EXPECT_EQ(std::make_tuple(std::uint64_t{start}, std::uint64_t{values.size()}, values.size() - start),
+                tracker.current());
+            EXPECT_EQ(types.size(), tracker.typeCount());
+        }
+    }
+}
+
+TEST(TokenInterner, AssignsDenseIds) {
+    algos::TokenInterner interner;
+    const std::string longToken(100000, 'x');
+    EXPECT_EQ(0u, interner.intern("error"));
+    EXPECT_EQ(1u, interner.intern("warning"));
+    EXPECT_EQ(0u, interner.intern(std::string{"error"}));
+    EXPECT_EQ(2u, interner.intern(""));
+    EXPECT_EQ(3u, interner.intern(longToken));
+    EXPECT_EQ(2u, interner.intern(""));
+    EXPECT_EQ(3u, interner.intern(longToken));
+    for (int i = 0; i < 10000; ++i) {
+        EXPECT_EQ(4u + i, interner.intern("token" + std::to_string(i)));
+    }
+    EXPECT_EQ(10004u, interner.size());
+    EXPECT_EQ("warning", interner.token(1));
+    EXPECT_EQ(longToken, interner.token(3));
+    EXPECT_EQ("token9999", interner.token(10003));
+    EXPECT_EQ(1u, interner.intern("warning"));
+}
+
+TEST(MinWindowSubstrInterned, FindsSameWindowAsMinWindowSubstr) {
+    std::mt19937 random{17};
+    algos::TokenInterner shared;
+    for (int round = 0; round < 300; ++round) {
+        std::vector<std::string> input(random() % 40);
+        const auto alphabet = 1 + random() % 8;
+        for (auto &value : input) {
+            value = "token-" + std::to_string(random() % alphabet);
+        }
+        const auto expected = algos::minWindowSubstr(input.cbegin(), input.cend());
+
+        EXPECT_EQ(expected, algos::minWindowSubstrInterned(input.cbegin(), input.cend()));
+        EXPECT_EQ(expected, algos::minWindowSubstrInterned(input.cbegin(), input.cend(), shared));
+    }
+    const std::vector<std::string_view> views{"a", "b", "a", "c", "b"};
+    EXPECT_EQ(algos::minWindowSubstr(views.cbegin(), views.cend()), algos::minWindowSubstrInterned(views.cbegin(), views.cend()));
+}
+
 //test todo
 // general value type, including structs/classes/enums
 // test iterator category check